@@ -17,22 +17,38 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <strings.h>
-
-typedef struct Card
-{
-  int value;
-  char spice;
-  struct Card *next;
-} Card;
-
-typedef struct Player
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "checkpoint.h"
+#include "command.h"
+#include "config.h"
+#include "deckgen.h"
+#include "endgame.h"
+#include "engine.h"
+#include "eventlog.h"
+#include "fairness.h"
+#include "input.h"
+#include "ismcts.h"
+#include "server.h"
+#include "simulate.h"
+#include "stats.h"
+#include "tournament.h"
+#include "turn.h"
+
+// The seats of the interactive game that are played by a strategy instead of from stdin. A seat without a decide
+// function is played by a human, who is shown the move of the endgame solver if advise is set and the chance that
+// the opponent's claim is false if hints is set.
+typedef struct Bots
 {
-  Card *hand;
-  int score;
-  Card *latest_card;  
-  Card *claimed_card; 
-} Player;
+  Seat seats[2];
+  IsmctsConfig search;
+  uint64_t rng;
+  uint16_t deck_counts[CARD_KINDS];
+  int advise;
+  int hints;
+} Bots;
 
 //---------------------------------------------------------------------------------------------------------------------
 /// Checks whether the correct number of command-line arguments has been provided.
@@ -50,638 +66,619 @@ int parseArg(int argc)
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-/// Checks the validity of the configuration file provided at the given path.
-/// Validates that the file exists and contains the correct header.
-/// @param config_path The path to the configuration file to be checked.
-/// @return 0 if the file is valid and can be used; 
-/// 2 if the file cannot be opened; 
-/// 3 if the file has an invalid format.
-int checkConfig(const char *config_path)
+/// Prints a header indicating the start of a new round.
+/// This function outputs a visually distinct separator and a "ROUND START" message.
+void printStart(void)
 {
-  FILE *config_file = fopen(config_path, "r");
-  if (!config_file)
-  {
-    printf("Error: Cannot open file: %s\n", config_path);
-    return 2;
-  }
-
-  char file_header[5];
-  if (fgets(file_header, sizeof(file_header), config_file) == NULL || strcmp(file_header, "ESP\n") != 0)
-  {
-    printf("Error: Invalid file: %s\n", config_path);
-    fclose(config_file);
-    return 3;
-  }
-
-  fclose(config_file);
-  return 0;
+  printf("\n-------------------\n");
+  printf("ROUND START\n");
+  printf("-------------------\n");
 }
 
-Card *parse_cards(const char *config_path)
-{
-  FILE *config_file = fopen(config_path, "r");
-  char line[10];
-  Card *head = NULL;
-  Card *tail = NULL;
 
-  fgets(line, sizeof(line), config_file);
 
-  while (fgets(line, sizeof(line), config_file))
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the outcome of a challenge made by one player against their opponent's claimed card.
+/// @param event A pointer to the challenge event.
+/// @param type The type of challenge ("value" or "spice") as it was entered.
+void printChallenge(const TurnEvent *event, const char *type)
+{
+  // The narration has always named player 1 as receiving the points of a successful challenge and player 2 as
+  // receiving the others, whoever challenged, and the expected outputs of the test cases depend on it.
+  const ChallengeResult *result = &event->result;
+  if (result->successful)
   {
-    int value;
-    char spice;
-
-    if (sscanf(line, "%d_%c\n", &value, &spice) != 2 || value < 1 || value > 10 || (spice != 'w' && spice != 'c' && spice != 'p'))
-    {
-      printf("Error: Invalid card format: %s", line);
-      fclose(config_file);
-      return NULL;
-    }
-
-    Card *new_card = malloc(sizeof(Card));
-    if (!new_card)
-    {
-      printf("Error: Out of memory\n");
-      fclose(config_file);
-      return NULL;
-    }
-
-    new_card->value = value;
-    new_card->spice = spice;
-    new_card->next = NULL;
+    printf("Challenge successful: %d_%c's %s does not match the real card %d_%c.\n",
+           event->claimed_value, event->claimed_spice, type, result->real_value, result->real_spice);
+    printf("Player 1 gets %d points.\n", result->points);
 
-    if (!head)
+    if (result->bonus)
     {
-      head = new_card;
-      tail = new_card;
-    }
-    else
-    {
-      tail->next = new_card;
-      tail = new_card;
+      printf("Player 2 gets %d bonus points (last card).\n", result->bonus);
     }
   }
-
-  fclose(config_file);
-  return head;
+  else
+  {
+    printf("Challenge failed: %d_%c's %s matches the real card %d_%c.\n",
+           event->claimed_value, event->claimed_spice, type, result->real_value, result->real_spice);
+    printf("Player 2 gets %d points.\n", result->points);
+  }
 }
 
-Card *reverse_cards(Card *head)
-{
-  Card *prev = NULL;
-  Card *current = head;
-  Card *next = NULL;
 
-  while (current)
+//---------------------------------------------------------------------------------------------------------------------
+/// Determines the winner of the game by comparing the scores of the two players.
+/// Outputs the scores of both players and announces the winner or a tie if the scores are equal.
+/// @param player1 A pointer to the first player's data structure, containing their score.
+/// @param player2 A pointer to the second player's data structure, containing their score.
+void determineWinner(Player *player1, Player *player2)
+{
+  if (player1->score > player2->score)
   {
-    next = current->next;
-    current->next = prev;
-    prev = current;
-    current = next;
+    printf("\nPlayer 1: %d points\n", player1->score);
+    printf("Player 2: %d points\n", player2->score);
+    printf("\nCongratulations! Player 1 wins the game!\n");
+  }
+  else if (player2->score > player1->score)
+  {
+    printf("\nPlayer 2: %d points\n", player2->score);
+    printf("Player 1: %d points\n", player1->score);
+    printf("\nCongratulations! Player 2 wins the game!\n");
+  }
+  else
+  {
+    printf("\nPlayer 1: %d points\n", player1->score);
+    printf("Player 2: %d points\n", player2->score);
+    printf("\nCongratulations! Player 1 wins the game!\n");
+    printf("Congratulations! Player 2 wins the game!\n");
   }
-
-  return prev;
 }
 
-Card *sort_cards(Card *head)
-{
-  if (!head || !head->next)
-    return head;
 
-  Card *sorted = NULL;
 
-  while (head)
-  {
-    Card *current = head;
-    head = head->next;
+//---------------------------------------------------------------------------------------------------------------------
+/// Lets a strategy choose the command of the player to move. The command is printed after the prompt as if it had
+/// been typed in, and a move that is not allowed is replaced by drawing a card.
+/// @param bots A pointer to the bots of the game.
+/// @param machine A pointer to the turn machine.
+/// @param command A pointer to the command to fill in.
+/// @param challenge_type A buffer of TOKEN_SIZE characters receiving the type of a challenge.
+void botCommand(Bots *bots, const TurnMachine *machine, TurnCommand *command, char *challenge_type)
+{
+  const GameState *state = &machine->state;
+  int seat = state->seat;
+  const Seat *bot = &bots->seats[seat];
+  TurnView view = {&state->players[seat], &state->players[1 - seat], &state->draw_pile, state->cards_played_this_round,
+                   state->latest_card_number, state->latest_card_spice, &bots->rng, bots->deck_counts,
+                   &machine->trackers[seat], seat};
+  Action action = {ACTION_DRAW, 0, '\0', 0, '\0', 0};
+  STATS_START(decide_started);
+  bot->decide(&view, &action, bot->context);
+  STATS_STOP(PHASE_DECIDE, decide_started);
 
-    if (!sorted || (current->spice < sorted->spice) ||
-        (current->spice == sorted->spice && current->value < sorted->value))
-    {
-      current->next = sorted;
-      sorted = current;
-    }
-    else
-    {
-      Card *temp = sorted;
-      while (temp->next && (temp->next->spice < current->spice ||
-                            (temp->next->spice == current->spice && temp->next->value < current->value)))
-      {
-        temp = temp->next;
-      }
-      current->next = temp->next;
-      temp->next = current;
-    }
+  if (!isLegalMove(state, &action))
+  {
+    action.type = ACTION_DRAW;
   }
+  command->error = TURN_OK;
+  command->has_cards = 1;
+  command->action = action;
 
-  return sorted;
+  printf("\nP%d > ", seat + 1);
+  if (action.type == ACTION_PLAY)
+  {
+    command->command = COMMAND_PLAY;
+    printf("play %d_%c %d_%c\n", action.hand_value, action.hand_spice, action.claimed_value, action.claimed_spice);
+  }
+  else if (action.type == ACTION_CHALLENGE)
+  {
+    command->command = COMMAND_CHALLENGE;
+    strcpy(challenge_type, action.challenge_value ? "value" : "spice");
+    printf("challenge %s\n", challenge_type);
+  }
+  else
+  {
+    command->command = COMMAND_DRAW;
+    printf("draw\n");
+  }
 }
 
+
 //---------------------------------------------------------------------------------------------------------------------
-/// Distributes cards from the deck to two players and a draw pile.
-/// Each player is initially dealt 6 cards, alternating between players.
-/// Remaining cards are added to the draw pile.
-/// @param deck The linked list of cards to be distributed.
-/// @param player1 The first player to receive cards.
-/// @param player2 The second player to receive cards.
-/// @param draw_pile A pointer to the draw pile where remaining cards will be stored.
-void distributeCards(Card *deck, Player *player1, Player *player2, Card **draw_pile)
+/// Prints the move the endgame solver recommends to a human player, once few enough cards are unseen.
+/// @param bots A pointer to the bots of the game, which hold the deck needed for counting cards.
+/// @param current_player A pointer to the current player's data structure.
+/// @param opponent A pointer to the opponent player's data structure.
+/// @param cards_played_this_round The number of cards played in the current round.
+/// @param draw_pile The draw pile of cards.
+/// @param tracker A pointer to the card counts of the current player.
+/// @param seat The seat of the current player, 0 for player 1.
+void printAdvice(Bots *bots, Player *current_player, Player *opponent, int cards_played_this_round,
+                 const DrawPile *draw_pile,
+                 const CardTracker *tracker, int seat)
 {
-  int player1_cards = 0, player2_cards = 0;
-  Card *current = deck;
-  int turn = 1;
-
-  while (current)
+  TurnView view = {current_player, opponent, draw_pile, cards_played_this_round, 0, '\0', &bots->rng,
+                   bots->deck_counts, tracker, seat};
+  EndgameAdvice advice;
+  if (solveEndgame(&view, &advice) != 0)
   {
-    Card *next_card = current->next;
-
-    if (player1_cards < 6 && turn == 1)
-    {
-      current->next = player1->hand;
-      player1->hand = current;
-      player1_cards++;
-      turn = 2;
-    }
-    else if (player2_cards < 6 && turn == 2)
-    {
-      current->next = player2->hand;
-      player2->hand = current;
-      player2_cards++;
-      turn = 1; 
-    }
-    else
-    {
-      current->next = *draw_pile;
-      *draw_pile = current;
-    }
-
-    current = next_card;
+    return;
   }
 
-  player1->hand = reverse_cards(player1->hand);
-  player2->hand = reverse_cards(player2->hand);
-  *draw_pile = reverse_cards(*draw_pile);
+  const Action *action = &advice.action;
+  printf("\n    endgame advice: ");
+  if (action->type == ACTION_PLAY)
+  {
+    printf("play %d_%c %d_%c", action->hand_value, action->hand_spice, action->claimed_value, action->claimed_spice);
+  }
+  else if (action->type == ACTION_CHALLENGE)
+  {
+    printf("challenge %s", action->challenge_value ? "value" : "spice");
+  }
+  else
+  {
+    printf("draw");
+  }
+  printf(" (estimated margin %+.2f)", advice.margin);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-/// Frees the memory allocated for a linked list of cards.
-/// This function traverses the list and deallocates memory for each card.
-/// @param head The head of the linked list to be freed.
-void freeCards(Card *head)
+/// Prints how likely the opponent's claim is false on value and on spice, judged by the cards the player has not
+/// seen yet.
+/// @param tracker A pointer to the card counts of the current player.
+/// @param opponent A pointer to the opponent player's data structure.
+void printHint(const CardTracker *tracker, const Player *opponent)
 {
-  while (head)
+  if (!opponent->has_played)
   {
-    Card *temp = head;
-    head = head->next;
-    free(temp);
+    return;
   }
-}
 
-//---------------------------------------------------------------------------------------------------------------------
-/// Prints a header indicating the start of a new round.
-/// This function outputs a visually distinct separator and a "ROUND START" message.
-void printStart(void)
-{
-  printf("\n-------------------\n");
-  printf("ROUND START\n");
-  printf("-------------------\n");
+  ClaimOdds odds;
+  claimOdds(tracker, opponent->claimed_card.value, opponent->claimed_card.spice, &odds);
+  printf("\n    claim odds: value false %.0f%%, spice false %.0f%%%s", 100.0 * odds.value_lie, 100.0 * odds.spice_lie,
+         odds.claim_unseen ? "" : " (no such card left)");
 }
 
 
-
 //---------------------------------------------------------------------------------------------------------------------
-/// Resets the round by deallocating the latest and claimed cards for both players.
-/// This function ensures all dynamically allocated cards for the current round are freed and resets the cards played count.
-/// @param player1 A pointer to the first player's data structure.
-/// @param player2 A pointer to the second player's data structure.
-/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
-void resetRound(Player *player1, Player *player2, int *cards_played_this_round)
+/// Prints the state of the game visible to the player to move: the latest claim of the opponent, the number of
+/// cards played this round and the hand cards in sorted order.
+/// @param state A pointer to the state of the game.
+void printTurn(const GameState *state)
 {
-  if (player1->latest_card)
-  {
-    free(player1->latest_card);
-    player1->latest_card = NULL;
-  }
+  const Player *current_player = &state->players[state->seat];
+  const Player *opponent = &state->players[1 - state->seat];
+
+  STATS_START(output_started);
+  printf("\nPlayer %d:\n", state->seat + 1);
 
-  if (player1->claimed_card)
+  if (opponent->has_played)
   {
-    free(player1->claimed_card);
-    player1->claimed_card = NULL;
+    printf("    latest played card: %d_%c\n", state->latest_card_number, state->latest_card_spice);
   }
-
-  if (player2->latest_card)
+  else
   {
-    free(player2->latest_card);
-    player2->latest_card = NULL;
+    printf("    latest played card:\n");
   }
 
-  if (player2->claimed_card)
+  printf("    cards played this round: %d\n", state->cards_played_this_round);
+  STATS_STOP(PHASE_OUTPUT, output_started);
+
+  STATS_START(sort_started);
+  printf("    hand cards:");
+  const Hand *hand = &current_player->hand;
+  for (int index = handFirst(hand); index >= 0; index = handNext(hand, index))
   {
-    free(player2->claimed_card);
-    player2->claimed_card = NULL;
+    for (int count = hand->counts[index]; count > 0; count--)
+    {
+      printf(" %d_%c", cardValue(index), cardSpice(index));
+    }
   }
-
-  *cards_played_this_round = 0;
+  STATS_STOP(PHASE_SORT, sort_started);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-/// Handles the "play" command from a player by verifying the card input and updating the game state.
-/// The function validates the player's input, removes the specified card from their hand, 
-/// and updates the latest and claimed card details.
-/// @param current_player A pointer to the player executing the command.
-/// @param opponent A pointer to the opponent player (used for context if needed).
-/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
-/// @param latest_card_number A pointer to the variable storing the value of the latest card played.
-/// @param latest_card_spice A pointer to the variable storing the spice of the latest card played.
-/// @return 0 if the play command is successful; 
-/// 1 if the input is invalid or the specified card is not in the player's hand.
-int handlePlayCommand(Player *current_player, Player *opponent, int *cards_played_this_round, int *latest_card_number, char *latest_card_spice)
+/// Prints the events of a step of the game and records the moves in the event log.
+/// @param machine A pointer to the turn machine.
+/// @param events A pointer to the events.
+/// @param expect The input the game expects after the step.
+/// @param challenge_type The type of the latest challenge as it was entered.
+/// @param log A pointer to the event log recording the game, or NULL.
+/// @param bots A pointer to the bots of the game.
+void printEvents(TurnMachine *machine, const TurnEvents *events, TurnExpect expect, const char *challenge_type, EventLog *log, Bots *bots)
 {
-  char hand_card_input[10];
-  char claimed_card_input[10];
-
-  if (scanf("%s %s", hand_card_input, claimed_card_input) != 2)
+  GameState *state = &machine->state;
+  for (int i = 0; i < events->count; i++)
   {
-    printf("Please enter the correct number of parameters!\n");
-    return 1;
+    const TurnEvent *event = &events->events[i];
+    switch (event->type)
+    {
+      case TURN_ROUND_START:
+        printStart();
+        break;
+      case TURN_TO_MOVE:
+        printTurn(state);
+        if (!bots->seats[event->seat].decide && bots->hints)
+        {
+          printHint(&machine->trackers[event->seat], &state->players[1 - event->seat]);
+        }
+        if (!bots->seats[event->seat].decide && bots->advise)
+        {
+          printAdvice(bots, &state->players[event->seat], &state->players[1 - event->seat],
+                      state->cards_played_this_round, &state->draw_pile, &machine->trackers[event->seat], event->seat);
+        }
+        break;
+      case TURN_PLAYED:
+        logPlay(log, event->seat, event->card, event->claimed_value, event->claimed_spice);
+        break;
+      case TURN_DREW:
+        logDraw(log, event->seat, event->card);
+        break;
+      case TURN_CHALLENGED:
+        logChallenge(log, event->seat, event->challenge_value, &event->result);
+        printChallenge(event, challenge_type);
+        break;
+      case TURN_CHALLENGE_REFUSED:
+        printf("Challenge cannot be used at the moment, because the opponent did not play a card on their latest turn.\n");
+        break;
+      case TURN_REJECTED:
+        if (event->error == TURN_WRONG_PARAMETERS)
+          printf(expect == EXPECT_CARDS ? "Please enter the correct number of parameters!\n"
+                                        : "Please enter the correct number of parameters!");
+        else if (event->error == TURN_CARD_FORMAT)
+          printf("Please enter the cards in the correct format!\n");
+        else if (event->error == TURN_NOT_IN_HAND)
+          printf("Please enter a card in your hand cards!\n");
+        else if (event->error == TURN_CHALLENGE_TYPE)
+          printf("Invalid challenge type! Please choose 'value' or 'spice'.\n");
+        else
+          printf("Please enter a valid command!\n");
+        break;
+      case TURN_GAME_OVER:
+        if (event->scored)
+        {
+          determineWinner(&state->players[event->seat], &state->players[1 - event->seat]);
+        }
+        break;
+    }
   }
+}
 
-  int hand_value, claimed_value;
-  char hand_spice, claimed_spice;
 
-  if (sscanf(hand_card_input, "%d_%c", &hand_value, &hand_spice) != 2 ||
-      sscanf(claimed_card_input, "%d_%c", &claimed_value, &claimed_spice) != 2)
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes the game to its checkpoint file, from which "--resume" continues it if the program ends before the game.
+/// A checkpoint that cannot be written is reported once and not written again.
+/// @param checkpoint_path A pointer to the path of the checkpoint file, which is set to NULL if writing fails.
+/// @param config_path The path of the configuration file of the game, or "".
+/// @param machine A pointer to the turn machine, which must wait for a command.
+/// @param bots A pointer to the bots of the game, whose deck counts and random state are saved with it.
+void checkpointGame(const char **checkpoint_path, const char *config_path, const TurnMachine *machine,
+                    const Bots *bots)
+{
+  CheckpointWriter *writer = createCheckpoint(*checkpoint_path, config_path);
+  if (writer)
   {
-    printf("Please enter the cards in the correct format!\n");
-    return 1;
+    addCheckpointGame(writer, machine, bots->deck_counts, 0, bots->rng);
   }
-
-  Card *prev = NULL, *current = current_player->hand;
-
-  while (current)
+  if (!writer || finishCheckpoint(writer) != 0)
   {
-    if (current->value == hand_value && current->spice == hand_spice)
-    {
-      if (prev)
-        prev->next = current->next;
-      else
-        current_player->hand = current->next;
-
-      current->next = NULL;
-      current_player->latest_card = current;
-
-      if (current_player->claimed_card)
-      {
-        free(current_player->claimed_card);
-      }
-
-      current_player->claimed_card = malloc(sizeof(Card));
-      if (!current_player->claimed_card)
-      {
-        printf("Error: Out of memory\n");
-        return 1;
-      }
-
-      *latest_card_number = claimed_value;
-      *latest_card_spice = claimed_spice;
-
-      current_player->claimed_card->value = claimed_value;
-      current_player->claimed_card->spice = claimed_spice;
-      current_player->claimed_card->next = NULL;
-
-      (*cards_played_this_round)++;
-      return 0;
-    }
-    prev = current;
-    current = current->next;
+    printf("Error: Cannot write file: %s\n", *checkpoint_path);
+    *checkpoint_path = NULL;
   }
-
-  printf("Please enter a card in your hand cards!\n");
-  return 1;
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-/// Handles a challenge made by one player against their opponent's claimed card.
-/// Validates the challenge based on the specified type (value or spice) and updates scores, 
-/// hands, and the draw pile accordingly.
-/// @param challenger A pointer to the player issuing the challenge.
-/// @param opponent A pointer to the player whose claimed card is being challenged.
-/// @param type The type of challenge ("value" or "spice"). Case insensitive.
-/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
-/// @param draw_pile A pointer to the draw pile where cards are stored.
-/// @param latest_played_card A pointer to the variable storing the value of the latest card played.
-/// @param latest_card_spice A pointer to the variable storing the spice of the latest card played.
-void handleChallenge(Player *challenger, Player *opponent, const char *type, int *cards_played_this_round, Card **draw_pile, int *latest_played_card, char *latest_card_spice)
+/// Loads the game of a checkpoint file written by checkpointGame to continue it.
+/// @param path The path of the checkpoint file.
+/// @param machine A pointer to the turn machine receiving the game.
+/// @param pile A pointer to the deck receiving the draw pile of the game, which the caller has to free.
+/// @param bots A pointer to the bots of the game, which receive the card counts of its deck and their random state.
+/// @param config_path A pointer to the variable receiving the path of the configuration file of the game, which
+/// the caller has to free.
+/// @return CONFIG_OK; CONFIG_CANNOT_OPEN if the file cannot be opened; CONFIG_INVALID_FILE if it is not a
+/// checkpoint of a single game; CONFIG_OUT_OF_MEMORY.
+int loadGame(const char *path, TurnMachine *machine, Deck *pile, Bots *bots, char **config_path)
 {
-  if (!opponent->claimed_card || !opponent->latest_card)
+  Checkpoint checkpoint;
+  pile->kinds = NULL;
+  *config_path = NULL;
+  int status = loadCheckpoint(path, &checkpoint);
+  if (status != CONFIG_OK)
   {
-    printf("Challenge cannot be used at the moment, because the opponent did not play a card on their latest turn.\n");
-    return;
+    return status;
+  }
+  if (checkpoint.count != 1)
+  {
+    closeCheckpoint(&checkpoint);
+    return CONFIG_INVALID_FILE;
+  }
+
+  const CheckpointRecord *record = checkpoint.records[0];
+  size_t source_length = strlen(checkpoint.source) + 1;
+  pile->kinds = malloc((size_t)record->pile_count + 1);
+  *config_path = malloc(source_length);
+  if (!pile->kinds || !*config_path)
+  {
+    closeCheckpoint(&checkpoint);
+    return CONFIG_OUT_OF_MEMORY;
   }
+  memcpy(*config_path, checkpoint.source, source_length);
+  pile->size = record->pile_count;
+  memcpy(bots->deck_counts, record->deck_counts, sizeof(bots->deck_counts));
+  bots->rng = record->rng;
+  restoreGame(record, pile->kinds, machine);
+  closeCheckpoint(&checkpoint);
+  return CONFIG_OK;
+}
 
-  int challenge_successful = 0;
 
-  if (strcasecmp(type, "value") != 0 && strcasecmp(type, "spice") != 0)
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays a game with challenges, alternating turns between two players, until the draw pile and both players'
+/// hands are empty or the game ends due to a quit command.
+/// Every command is read or chosen by a bot, executed by the turn machine, and its events are printed. With a
+/// checkpoint file, the game is written to it whenever a player is to enter a command, and the file is removed
+/// once the game has ended by the rules. A game that was quit or whose input ended keeps its checkpoint, so it can
+/// be resumed.
+/// @param machine A pointer to the turn machine playing the game.
+/// @param deck The deck of the game in dealing order, or NULL to continue the game restored in the machine.
+/// @param log A pointer to the event log recording the game, or NULL.
+/// @param bots A pointer to the bots of the game.
+/// @param input A pointer to the reader of the commands.
+/// @param checkpoint_path The path of the checkpoint file, or NULL.
+/// @param config_path The path of the configuration file of the game, or "".
+/// @return 1 if the game ended by the rules; 0 if it was quit or the input ended.
+int roundWithChallenges(TurnMachine *machine, const Deck *deck, EventLog *log, Bots *bots, CommandReader *input,
+                        const char *checkpoint_path, const char *config_path)
+{
+  char challenge_type[TOKEN_SIZE] = "";
+  TurnEvents events;
+  TurnExpect expect = deck ? startTurns(machine, deck->kinds, deck->size, &events) : resumeTurns(machine, &events);
+  printEvents(machine, &events, expect, challenge_type, log, bots);
+  if (checkpoint_path && expect == EXPECT_COMMAND)
   {
-    printf("Please choose SPICE or VALUE!\n");
-    return;
+    checkpointGame(&checkpoint_path, config_path, machine, bots);
   }
 
-  if (strcasecmp(type, "value") == 0)
+  while (expect != EXPECT_NOTHING)
   {
-    if (opponent->claimed_card->value != opponent->latest_card->value)
+    int player_number = machine->state.seat + 1;
+    int human = !bots->seats[player_number - 1].decide;
+    TurnCommand command;
+    if (!human)
     {
-      challenge_successful = 1;
+      botCommand(bots, machine, &command, challenge_type);
     }
-  }
-  else if (strcasecmp(type, "spice") == 0)
-  {
-    if (opponent->claimed_card->spice != opponent->latest_card->spice)
+    else
     {
-      challenge_successful = 1;
+      // A play whose cards were rejected asks for other cards on a short prompt; the cards of a play that has just
+      // been entered are read without a prompt.
+      if (expect == EXPECT_COMMAND)
+        printf("\nP%d > ", player_number);
+      else if (events.count > 0)
+        printf("P%d > ", player_number);
+      readCommand(input, expect, &command, challenge_type);
     }
-  }
 
-  if (challenge_successful)
-  {
-    printf("Challenge successful: %d_%c's %s does not match the real card %d_%c.\n",
-           *latest_played_card, *latest_card_spice, type,
-           opponent->latest_card->value, opponent->latest_card->spice);
-
-    challenger->score += *cards_played_this_round;
-    printf("Player %d gets %d points.\n", (challenger == opponent ? 2 : 1), *cards_played_this_round);
-
-    for (int i = 0; i < 2 && *draw_pile; i++)
+    expect = stepTurn(machine, &command, &events);
+    printEvents(machine, &events, expect, challenge_type, log, bots);
+    if (checkpoint_path && expect == EXPECT_COMMAND)
     {
-      Card *new_card = *draw_pile;
-      *draw_pile = new_card->next;
-      new_card->next = opponent->hand;
-      opponent->hand = new_card;
+      checkpointGame(&checkpoint_path, config_path, machine, bots);
     }
 
-    if (!opponent->hand)
+    if (human && expect == EXPECT_COMMAND)
     {
-      printf("Player %d gets 10 bonus points (last card).\n", (challenger == opponent ? 1 : 2));
-      challenger->score += 10;
+      skipLine(input);
     }
   }
-  else
+  const TurnEvent *last = &events.events[events.count - 1];
+  int scored = last->type == TURN_GAME_OVER && last->scored;
+  if (checkpoint_path && scored)
   {
-    printf("Challenge failed: %d_%c's %s matches the real card %d_%c.\n",
-           *latest_played_card, *latest_card_spice, type,
-           opponent->latest_card->value, opponent->latest_card->spice);
-
-    opponent->score += *cards_played_this_round;
-    printf("Player %d gets %d points.\n", (challenger == opponent ? 1 : 2), *cards_played_this_round);
-
-    for (int i = 0; i < 2 && *draw_pile; i++)
-    {
-      Card *new_card = *draw_pile;
-      *draw_pile = new_card->next;
-      new_card->next = challenger->hand;
-      challenger->hand = new_card;
-    }
+    remove(checkpoint_path);
   }
-
-  resetRound(challenger, opponent, cards_played_this_round);
+  return scored;
 }
 
 
-
 //---------------------------------------------------------------------------------------------------------------------
-/// Determines the winner of the game by comparing the scores of the two players.
-/// Outputs the scores of both players and announces the winner or a tie if the scores are equal.
-/// @param player1 A pointer to the first player's data structure, containing their score.
-/// @param player2 A pointer to the second player's data structure, containing their score.
-void determineWinner(Player *player1, Player *player2)
+/// The main entry point for the game "Entertaining Spice Pretending."
+/// This function initializes the game by parsing arguments, validating the configuration file, 
+/// creating the card deck, distributing cards to players, and starting the game rounds.
+/// Cleans up allocated memory and handles errors appropriately. "--simulate" or "--tournament" as first argument
+/// starts the headless batch simulation or the multi-core tournament instead of an interactive game, "--replay"
+/// verifies an event log, "--bench" runs the benchmarks, "--generate" writes a random deck and "--serve" hosts games
+/// for clients of a Unix domain socket. "--log <log file>" before the configuration file records the game as an event log, and
+/// "--p1 <strategy>" or "--p2 <strategy>" lets a built-in strategy play that seat. "--stats" prints the time spent in
+/// each phase of a turn after the game, "--advise" shows human players the move of the endgame solver and "--hints"
+/// how likely the opponent's claim is false by the cards they have not seen. "--checkpoint <file>" keeps the game
+/// in a checkpoint file until it is over, and "--resume" continues the game of a checkpoint file given instead of
+/// the configuration file, writing further checkpoints to the same file. "--fairness" as first argument computes the
+/// chances of both seats over all deals of a deck instead. The final scores of a game played to its end are added
+/// to the score block of the configuration file.
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// @return 0 if the program executes successfully; 
+/// non-zero error codes for invalid arguments, configuration file errors, or other issues.
+int main(int argc, char *argv[])
 {
-  if (player1->score > player2->score)
+  if (argc > 1 && strcmp(argv[1], "--simulate") == 0)
   {
-    printf("\nPlayer 1: %d points\n", player1->score);
-    printf("Player 2: %d points\n", player2->score);
-    printf("\nCongratulations! Player 1 wins the game!\n");
+    return runSimulation(argc, argv);
   }
-  else if (player2->score > player1->score)
+  if (argc > 1 && strcmp(argv[1], "--tournament") == 0)
   {
-    printf("\nPlayer 2: %d points\n", player2->score);
-    printf("Player 1: %d points\n", player1->score);
-    printf("\nCongratulations! Player 2 wins the game!\n");
+    return runTournament(argc, argv);
   }
-  else
+  if (argc > 1 && strcmp(argv[1], "--replay") == 0)
   {
-    printf("\nPlayer 1: %d points\n", player1->score);
-    printf("Player 2: %d points\n", player2->score);
-    printf("\nCongratulations! Player 1 wins the game!\n");
-    printf("Congratulations! Player 2 wins the game!\n");
+    return runReplay(argc, argv);
   }
-}
-
-
-
-//---------------------------------------------------------------------------------------------------------------------
-/// Handles a single turn for the current player in the game.
-/// The player can issue commands such as "play," "challenge," "quit," or "draw," and the game state updates accordingly.
-/// Validates commands, executes actions, and checks for end-of-game conditions.
-/// @param player_number The identifier of the current player (e.g., 1 or 2).
-/// @param current_player A pointer to the current player's data structure.
-/// @param opponent A pointer to the opponent player's data structure.
-/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
-/// @param draw_pile A pointer to the draw pile of cards.
-/// @param game_over A pointer to the flag indicating if the game has ended.
-/// @param latest_played_card A pointer to the variable storing the value of the latest card played.
-/// @param latest_card_spice A pointer to the variable storing the spice of the latest card played.
-void playerTurn(int player_number, Player *current_player, Player *opponent, int *cards_played_this_round, Card **draw_pile, int *game_over, int *latest_played_card, int *latest_card_spice)
-{
-  printf("\nPlayer %d:\n", player_number);
-
-  if (opponent->claimed_card)
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0)
   {
-    printf("    latest played card: %d_%c\n", *latest_played_card, *latest_card_spice);
+    return runBenchmarks(argc, argv);
   }
-  else
+  if (argc > 1 && strcmp(argv[1], "--generate") == 0)
   {
-    printf("    latest played card:\n");
+    return runGenerate(argc, argv);
   }
-
-  printf("    cards played this round: %d\n", *cards_played_this_round);
-
-  printf("    hand cards:");
-  current_player->hand = sort_cards(current_player->hand);
-  Card *current = current_player->hand;
-  while (current)
+  if (argc > 1 && strcmp(argv[1], "--serve") == 0)
   {
-    printf(" %d_%c", current->value, current->spice);
-    current = current->next;
+    return runServer(argc, argv);
+  }
+  if (argc > 1 && strcmp(argv[1], "--fairness") == 0)
+  {
+    return runFairness(argc, argv);
   }
 
-  int wrong_input = 1;
+  const char *log_path = NULL;
+  const char *checkpoint_path = NULL;
+  int resume = 0;
+  Bots bots;
+  memset(&bots, 0, sizeof(bots));
+  bots.search = ISMCTS_DEFAULTS;
+  bots.rng = (uint64_t)time(NULL);
 
-  while (wrong_input)
+  int option = 1;
+  for (; option + 1 < argc; option += 2)
   {
-    wrong_input = 0;
-    printf("\nP%d > ", player_number);
-
-    char command[10];
-    scanf("%s", command);
-    if (strcasecmp(command, "play") == 0)
+    if (strcmp(argv[option], "--stats") == 0)
     {
-      while (handlePlayCommand(current_player, opponent, cards_played_this_round, latest_played_card, latest_card_spice) != 0)
-      {
-        printf("P%d > ", player_number);
-      }
+      enableStats();
+      option--;
     }
-    else if (strcasecmp(command, "challenge") == 0)
+    else if (strcmp(argv[option], "--advise") == 0)
     {
-      char type[10];
-      scanf("%s", type);
-
-      if (strcasecmp(type, "value") != 0 && strcasecmp(type, "spice") != 0)
-      {
-        printf("Invalid challenge type! Please choose 'value' or 'spice'.\n");
-      }
-      else
-      {
-        handleChallenge(current_player, opponent, type, cards_played_this_round, draw_pile, latest_played_card, latest_card_spice);
-
-        if (!*draw_pile)
-        {
-          *game_over = 1;
-          determineWinner(current_player, opponent);
-          return;
-        }
-
-        printStart();
-      }
+      bots.advise = 1;
+      option--;
     }
-    else if (strcasecmp(command, "quit") == 0)
+    else if (strcmp(argv[option], "--hints") == 0)
     {
-      char extra_input[10];
-      if (scanf("%s", extra_input) != EOF)
-      {
-        printf("Please enter the correct number of parameters!");
-        wrong_input = 1;
-      } else {
-        *game_over = 1;
-      }
+      bots.hints = 1;
+      option--;
     }
-    else if (strcasecmp(command, "draw") == 0)
+    else if (strcmp(argv[option], "--resume") == 0)
     {
-      if (!*draw_pile)
-      {
-        *game_over = 1;
-        determineWinner(current_player, opponent);
-        return; 
-      }
-      else
-      {
-        Card *drawn_card = *draw_pile;
-        *draw_pile = drawn_card->next;
-        drawn_card->next = current_player->hand;
-        current_player->hand = drawn_card;
-
-        if (!*draw_pile)
-        {
-          *game_over = 1;
-          determineWinner(current_player, opponent);
-          return;
-        }
-      }
+      resume = 1;
+      option--;
     }
-    else
+    else if (option + 2 >= argc)
     {
-      printf("Please enter a valid command!\n");
+      break;
     }
-
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF)
+    else if (strcmp(argv[option], "--log") == 0)
     {
+      log_path = argv[option + 1];
     }
-  }
-}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-/// Conducts a game round with challenges, alternating turns between two players.
-/// The round continues until the draw pile and both players' hands are empty or the game ends due to a quit command.
-/// Validates and processes each player's turn and determines the winner if the game ends.
-/// @param player1 A pointer to the first player's data structure.
-/// @param player2 A pointer to the second player's data structure.
-/// @param draw_pile A pointer to the draw pile of cards.
-void roundWithChallenges(Player *player1, Player *player2, Card **draw_pile)
-{
-  int game_over = 0; 
-  int latest_card_number = 0;
-  int latest_card_spice = '\0';
-
-  while (!game_over && (*draw_pile || player1->hand || player2->hand))
-  {
-    printStart();
-    int cards_played_this_round = 0;
-
-    while (!game_over && (*draw_pile || player1->hand || player2->hand))
+    else if (strcmp(argv[option], "--checkpoint") == 0)
     {
-      playerTurn(1, player1, player2, &cards_played_this_round, draw_pile, &game_over, &latest_card_number, &latest_card_spice);
-
-      if (game_over)
+      checkpoint_path = argv[option + 1];
+    }
+    else if (strcmp(argv[option], "--p1") == 0 || strcmp(argv[option], "--p2") == 0)
+    {
+      if (findStrategy(argv[option + 1], &bots.seats[argv[option][3] - '1']) != 0)
       {
         break;
       }
-      playerTurn(2, player2, player1, &cards_played_this_round, draw_pile, &game_over, &latest_card_number, &latest_card_spice);
     }
-
-    if (!*draw_pile && !player1->hand && !player2->hand && !game_over)
+    else if (strcmp(argv[option], "--seed") == 0)
+    {
+      bots.rng = strtoull(argv[option + 1], NULL, 10);
+    }
+    else
     {
-      determineWinner(player1, player2);
+      int index = option;
+      if (parseSearchOption(argv, &index, argc - 1, &bots.search) != 0)
+      {
+        break;
+      }
     }
   }
-}
-
+  argv += option - 1;
+  argc -= option - 1;
 
-//---------------------------------------------------------------------------------------------------------------------
-/// The main entry point for the game "Entertaining Spice Pretending."
-/// This function initializes the game by parsing arguments, validating the configuration file, 
-/// creating the card deck, distributing cards to players, and starting the game rounds.
-/// Cleans up allocated memory and handles errors appropriately.
-/// @param argc The number of arguments passed to the program from the command line.
-/// @param argv An array of strings representing the command-line arguments.
-/// @return 0 if the program executes successfully; 
-/// non-zero error codes for invalid arguments, configuration file errors, or other issues.
-int main(int argc, char *argv[])
-{
-  int result = parseArg(argc);
+  // An event log starts with the deal, which a resumed game does not have.
+  int result = parseArg(resume && log_path ? 0 : argc);
   if (result != 0)
   {
     return result;
   }
 
-  result = checkConfig(argv[1]);
-  if (result != 0)
+  Deck config;
+  TurnMachine machine;
+  char *resumed_config_path = NULL;
+  char invalid_line[CONFIG_LINE_SIZE];
+  int status = resume ? loadGame(argv[1], &machine, &config, &bots, &resumed_config_path)
+                      : loadConfig(argv[1], &config, invalid_line);
+  if (status == CONFIG_CANNOT_OPEN || status == CONFIG_INVALID_FILE)
   {
-    return result;
+    printConfigError(status, argv[1], invalid_line);
+    return configExitCode(status);
+  }
+  const char *config_path = resume ? resumed_config_path : argv[1];
+  if (resume && !checkpoint_path)
+  {
+    checkpoint_path = argv[1];
+  }
+
+  EventLog *log = NULL;
+  if (log_path && status == CONFIG_OK && !(log = openEventLog(log_path)))
+  {
+    printf("Error: Cannot open file: %s\n", log_path);
+    free(config.kinds);
+    return 2;
   }
 
   printf("Welcome to Entertaining Spice Pretending!\n");
 
-  Card *deck = parse_cards(argv[1]);
-  if (!deck)
+  if (status != CONFIG_OK)
   {
+    printConfigError(status, argv[1], invalid_line);
+    free(config.kinds);
+    free(resumed_config_path);
+    closeEventLog(log);
     return 3;
   }
+  logDeal(log, config.kinds, config.size);
+  for (int i = 0; i < config.size && !resume; i++)
+  {
+    bots.deck_counts[config.kinds[i]]++;
+  }
+  useSearchConfig(&bots.seats[0], &bots.search);
+  useSearchConfig(&bots.seats[1], &bots.search);
 
-  Player player1 = {NULL, 0, NULL, NULL};
-  Player player2 = {NULL, 0, NULL, NULL};
-  Card *draw_pile = NULL;
-
-  distributeCards(deck, &player1, &player2, &draw_pile);
+  STATS_START(game_started);
+  static CommandReader input;
+  initCommandReader(&input, STDIN_FILENO);
+  int scored = roundWithChallenges(&machine, resume ? NULL : &config, log, &bots, &input, checkpoint_path,
+                                   config_path);
+  STATS_STOP(PHASE_GAME, game_started);
 
-  roundWithChallenges(&player1, &player2, &draw_pile);
+  const Player *players = machine.state.players;
+  logEnd(log, players[0].score, players[1].score);
+  if (closeEventLog(log) != 0)
+  {
+    printf("Error: Cannot write file: %s\n", log_path);
+  }
 
-  freeCards(player1.hand);
-  freeCards(player2.hand);
-  freeCards(draw_pile);
+  // Only a game played to its end counts, a game ended by "quit" leaves the configuration file untouched.
+  if (scored && *config_path)
+  {
+    ScoreTotals results = {1, {players[0].score > players[1].score, players[1].score > players[0].score},
+                           players[0].score == players[1].score, {players[0].score, players[1].score}};
+    status = saveScores(config_path, &results);
+    if (status != CONFIG_OK)
+    {
+      printConfigError(status, config_path, invalid_line);
+    }
+  }
+  free(config.kinds);
+  free(resumed_config_path);
+  printStats();
 
-  return 0;
+  return configExitCode(status);
 }
@@ -0,0 +1,572 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Benchmark suite of "Entertaining Spice Pretending".
+//
+// Every benchmark is a function running a given number of operations. The number of operations per sample is
+// doubled until a sample takes at least MIN_SAMPLE_SECONDS, which also warms up the caches, and then the samples are
+// timed one by one. The time per operation of the samples is sorted to report the minimum, percentiles and maximum,
+// as a table on stdout and optionally as JSON for comparing runs across commits.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "command.h"
+#include "config.h"
+#include "deckgen.h"
+#include "simulate.h"
+
+#define DEFAULT_SAMPLES 30
+#define MAX_SAMPLES 100000
+#define MIN_SAMPLE_SECONDS 0.002
+#define BENCH_NAME_SIZE 64
+#define BENCH_DECK_SIZE 60
+
+typedef void (*BenchFunction)(void *context, long long operations);
+
+typedef struct BenchResult
+{
+  char name[BENCH_NAME_SIZE];
+  long long operations;
+  int samples;
+  double min;
+  double p50;
+  double p90;
+  double p99;
+  double max;
+  double mean;
+} BenchResult;
+
+typedef struct BenchContext
+{
+  const DeckTable *decks;
+  int deck;
+  uint8_t *kinds;
+  Player player;
+  GameState state;
+  Seat seats[2];
+  uint64_t rng;
+  DeckSampler sampler;
+  uint8_t generated[BENCH_DECK_SIZE];
+  FILE *script;
+  CommandReader *reader;
+  TurnMachine machine;
+  // Accumulates results of the benchmarked work so that the compiler cannot drop it.
+  long long sink;
+} BenchContext;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Loads the configuration files of the table in turn.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of files to load.
+static void benchLoadConfig(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  for (long long i = 0; i < operations; i++)
+  {
+    Deck deck;
+    char invalid_line[CONFIG_LINE_SIZE];
+    if (loadConfig(bench->decks->entries[i % bench->decks->count].path, &deck, invalid_line) == CONFIG_OK)
+    {
+      bench->sink += deck.size;
+      free(deck.kinds);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Deals the decks in turn to two players and the draw pile.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of decks to deal.
+static void benchDeal(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  for (long long i = 0; i < operations; i++)
+  {
+    Deck deck = tableDeck(bench->decks, i % bench->decks->count);
+    Player player1 = {{0, 0, {0}}, 0, 0, {0, '\0'}, {0, '\0'}};
+    Player player2 = {{0, 0, {0}}, 0, 0, {0, '\0'}, {0, '\0'}};
+    DrawPile draw_pile;
+    distributeCards(deck.kinds, deck.size, &player1, &player2, &draw_pile);
+    bench->sink += player1.hand.size + player2.hand.size + pileCount(&draw_pile);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Lists the cards of a dealt hand in sorted order, as the hand display of playerTurn does.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of times the hand is listed.
+static void benchHandOrder(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  const Hand *hand = &bench->player.hand;
+  for (long long i = 0; i < operations; i++)
+  {
+    for (int index = handFirst(hand); index >= 0; index = handNext(hand, index))
+    {
+      for (int count = hand->counts[index]; count > 0; count--)
+      {
+        bench->sink += index;
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays cards from a dealt hand with playCard, alternating between a card in the hand, which is put back
+/// afterwards, and a card that is looked up in vain.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of cards to play.
+static void benchPlayCard(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  Player *player = &bench->player;
+  int cards_played_this_round = 0;
+  int latest_card_number = 0;
+  int latest_card_spice = '\0';
+
+  for (long long i = 0; i < operations; i++)
+  {
+    int index = (int)(i * 7 % CARD_KINDS);
+    if (playCard(player, cardValue(index), cardSpice(index), cardValue(index), cardSpice(index),
+                 &cards_played_this_round, &latest_card_number, &latest_card_spice) == 0)
+    {
+      handAdd(&player->hand, index);
+    }
+  }
+  bench->sink += cards_played_this_round;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Copies a state in which player 1 has just played a card and lets player 2 challenge it, alternating between
+/// the value and the spice.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of challenges to resolve.
+static void benchChallenge(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  Action challenge = {ACTION_CHALLENGE, 0, '\0', 0, '\0', 0};
+  for (long long i = 0; i < operations; i++)
+  {
+    GameState state;
+    MoveUndo undo;
+    cloneGameState(&state, &bench->state);
+    challenge.challenge_value = (int)(i & 1);
+    applyMove(&state, &challenge, &undo);
+    bench->sink += state.players[0].score + state.players[1].score;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Generates decks of BENCH_DECK_SIZE cards with uniform weights, each from its own seed.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of decks to generate.
+static void benchGenerate(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  for (long long i = 0; i < operations; i++)
+  {
+    generateDeck(&bench->sampler, BENCH_DECK_SIZE, deckSeed(bench->rng, i), bench->generated);
+    bench->sink += bench->generated[0];
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Shuffles a deck of BENCH_DECK_SIZE cards again and again.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of shuffles.
+static void benchShuffle(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  for (long long i = 0; i < operations; i++)
+  {
+    shuffleDeck(bench->generated, BENCH_DECK_SIZE, &bench->rng);
+    bench->sink += bench->generated[0];
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays complete games on one deck, shuffling it before every game.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of games to play.
+static void benchGame(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  Deck deck = tableDeck(bench->decks, bench->deck);
+  for (long long i = 0; i < operations; i++)
+  {
+    memcpy(bench->kinds, deck.kinds, deck.size);
+    shuffleDeck(bench->kinds, deck.size, &bench->rng);
+    GameResult outcome;
+    playGame(bench->kinds, deck.size, bench->seats, NULL, &bench->rng, &outcome, NULL, NULL);
+    bench->sink += outcome.turns;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays a deck with a fixed pattern of commands and writes them as a player would type them: every fourth
+/// turn challenges a claim, the others play the lowest hand card, every second play as a lie, or draw.
+/// The file is emptied first, so it holds the session of one deck at a time.
+/// @param deck The deck of the session in dealing order.
+/// @param script The file receiving the commands.
+/// @param machine A pointer to the turn machine to play the session with.
+/// @return 0 if the script was written; 1 otherwise.
+static int writeSession(const Deck *deck, FILE *script, TurnMachine *machine)
+{
+  rewind(script);
+  if (ftruncate(fileno(script), 0) != 0)
+  {
+    return 1;
+  }
+  TurnEvents events;
+  TurnExpect expect = startTurns(machine, deck->kinds, deck->size, &events);
+  for (int turn = 0; expect == EXPECT_COMMAND; turn++)
+  {
+    const GameState *state = &machine->state;
+    const Player *player = &state->players[state->seat];
+    TurnCommand command = {COMMAND_DRAW, TURN_OK, 0, {ACTION_DRAW, 0, '\0', 0, '\0', 0}};
+    int index = handFirst(&player->hand);
+    if (state->players[1 - state->seat].has_played && turn % 4 == 3)
+    {
+      command.command = COMMAND_CHALLENGE;
+      command.action.type = ACTION_CHALLENGE;
+      command.action.challenge_value = turn % 8 == 3;
+      fprintf(script, "challenge %s\n", command.action.challenge_value ? "value" : "spice");
+    }
+    else if (index >= 0)
+    {
+      Action play = {ACTION_PLAY, cardValue(index), cardSpice(index),
+                     turn % 2 ? cardValue(index) % CARD_VALUES + 1 : cardValue(index), cardSpice(index), 0};
+      command.command = COMMAND_PLAY;
+      command.has_cards = 1;
+      command.action = play;
+      fprintf(script, "play %d_%c %d_%c\n", cardValue(index), cardSpice(index), command.action.claimed_value,
+              command.action.claimed_spice);
+    }
+    else
+    {
+      fprintf(script, "draw\n");
+    }
+    expect = stepTurn(machine, &command, &events);
+  }
+  return expect != EXPECT_NOTHING || fflush(script) != 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays the session of the current deck written by writeSession again and again as the interactive game plays it:
+/// the commands are read from the file by a command reader, parsed by readCommand and executed by stepTurn. Nothing
+/// is printed.
+/// @param context A pointer to the benchmark context.
+/// @param operations The number of sessions to play.
+static void benchSession(void *context, long long operations)
+{
+  BenchContext *bench = context;
+  Deck deck = tableDeck(bench->decks, bench->deck);
+  char challenge_type[TOKEN_SIZE];
+  for (long long i = 0; i < operations; i++)
+  {
+    lseek(fileno(bench->script), 0, SEEK_SET);
+    initCommandReader(bench->reader, fileno(bench->script));
+    TurnEvents events;
+    TurnExpect expect = startTurns(&bench->machine, deck.kinds, deck.size, &events);
+    while (expect != EXPECT_NOTHING)
+    {
+      TurnCommand command;
+      readCommand(bench->reader, expect, &command, challenge_type);
+      expect = stepTurn(&bench->machine, &command, &events);
+      if (expect == EXPECT_COMMAND)
+      {
+        skipLine(bench->reader);
+      }
+    }
+    bench->sink += bench->machine.state.players[0].score;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Compares two sample times for qsort.
+/// @param a A pointer to the first time.
+/// @param b A pointer to the second time.
+/// @return A negative number, 0 or a positive number if the first time is shorter, equal or longer.
+static int compareTimes(const void *a, const void *b)
+{
+  double first = *(const double *)a;
+  double second = *(const double *)b;
+  return (first > second) - (first < second);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Runs one benchmark and computes the statistics of its samples.
+/// @param name The name of the benchmark.
+/// @param run The benchmark function.
+/// @param context The context handed to the benchmark function.
+/// @param samples The number of samples to take.
+/// @param times A buffer of at least samples entries for the sample times.
+/// @param result A pointer to the structure receiving the statistics in nanoseconds per operation.
+static void measure(const char *name, BenchFunction run, void *context, int samples, double *times,
+                    BenchResult *result)
+{
+  long long operations = 1;
+  for (;;)
+  {
+    double start = currentSeconds();
+    run(context, operations);
+    if (currentSeconds() - start >= MIN_SAMPLE_SECONDS || operations >= (1LL << 40))
+    {
+      break;
+    }
+    operations *= 2;
+  }
+
+  double total = 0.0;
+  for (int i = 0; i < samples; i++)
+  {
+    double start = currentSeconds();
+    run(context, operations);
+    times[i] = (currentSeconds() - start) * 1e9 / operations;
+    total += times[i];
+  }
+  qsort(times, samples, sizeof(double), compareTimes);
+
+  snprintf(result->name, sizeof(result->name), "%s", name);
+  result->operations = operations;
+  result->samples = samples;
+  result->min = times[0];
+  result->p50 = times[(samples - 1) * 50 / 100];
+  result->p90 = times[(samples - 1) * 90 / 100];
+  result->p99 = times[(samples - 1) * 99 / 100];
+  result->max = times[samples - 1];
+  result->mean = total / samples;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes a string as a JSON string literal. Quotes, backslashes and control characters, which can appear in the
+/// file names the game benchmarks are named after, are escaped.
+/// @param file The file to write to.
+/// @param text The string.
+static void writeJsonString(FILE *file, const char *text)
+{
+  fputc('"', file);
+  for (const unsigned char *c = (const unsigned char *)text; *c; c++)
+  {
+    if (*c == '"' || *c == '\\')
+      fprintf(file, "\\%c", *c);
+    else if (*c < 0x20)
+      fprintf(file, "\\u%04x", *c);
+    else
+      fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes the results as a JSON document.
+/// @param path The path of the file to write.
+/// @param results The results of the benchmarks.
+/// @param count The number of results.
+/// @return 0 if the file was written; 1 otherwise.
+static int writeJson(const char *path, const BenchResult *results, int count)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+  {
+    return 1;
+  }
+
+  fprintf(file, "{\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n");
+  for (int i = 0; i < count; i++)
+  {
+    const BenchResult *result = &results[i];
+    fprintf(file, "    {\"name\": ");
+    writeJsonString(file, result->name);
+    fprintf(file,
+            ", \"operations\": %lld, \"samples\": %d, \"min\": %.2f, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, "
+            "\"max\": %.2f, \"mean\": %.2f, \"ops_per_second\": %.0f}%s\n",
+            result->operations, result->samples, result->min, result->p50, result->p90, result->p99,
+            result->max, result->mean, result->p50 > 0 ? 1e9 / result->p50 : 0.0, i + 1 < count ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+  return fclose(file) != 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the usage of the benchmark mode.
+/// @return 1, the exit code for invalid arguments.
+static int benchUsage(void)
+{
+  printf("Usage: ./a4-csf --bench [--samples <count>] [--json <file>] <config directory>\n");
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Entry point of the benchmark mode started with "--bench".
+/// Runs every benchmark on the decks of the configuration directory and prints one line of statistics per
+/// benchmark; "--json" also writes the results to a file.
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// @return 0 if the benchmarks finished; 1 for invalid arguments; 2 or 3 for configuration or output file errors;
+/// 4 if there is not enough memory.
+int runBenchmarks(int argc, char *argv[])
+{
+  int samples = DEFAULT_SAMPLES;
+  const char *json_path = NULL;
+
+  int i = 2;
+  for (; i + 1 < argc; i += 2)
+  {
+    if (strcmp(argv[i], "--samples") == 0)
+    {
+      samples = atoi(argv[i + 1]);
+      if (samples < 1 || samples > MAX_SAMPLES)
+      {
+        return benchUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--json") == 0)
+    {
+      json_path = argv[i + 1];
+    }
+    else
+    {
+      return benchUsage();
+    }
+  }
+  if (i != argc - 1)
+  {
+    return benchUsage();
+  }
+
+  DeckTable decks;
+  memset(&decks, 0, sizeof(decks));
+  int status = loadConfigDirectory(argv[i], &decks);
+  if (status != CONFIG_OK)
+  {
+    printConfigError(status, argv[i], "");
+    freeDeckTable(&decks);
+    return configExitCode(status);
+  }
+  if (decks.count == 0)
+  {
+    printf("Error: No valid configuration files\n");
+    freeDeckTable(&decks);
+    return 3;
+  }
+
+  int max_deck_size = 0;
+  for (int d = 0; d < decks.count; d++)
+  {
+    if (decks.entries[d].size > max_deck_size)
+    {
+      max_deck_size = decks.entries[d].size;
+    }
+  }
+
+  BenchContext bench;
+  memset(&bench, 0, sizeof(bench));
+  bench.decks = &decks;
+  bench.rng = 1;
+  bench.kinds = malloc(max_deck_size);
+  bench.reader = malloc(sizeof(CommandReader));
+  double *times = malloc(sizeof(double) * samples);
+  BenchResult *results = malloc(sizeof(BenchResult) * (7 + 2 * (size_t)decks.count));
+  if (!bench.kinds || !bench.reader || !times || !results)
+  {
+    printf("Error: Out of memory\n");
+    free(bench.kinds);
+    free(bench.reader);
+    free(times);
+    free(results);
+    freeDeckTable(&decks);
+    return 4;
+  }
+  findStrategy("random", &bench.seats[0]);
+  findStrategy("random", &bench.seats[1]);
+  initDeckSampler(&bench.sampler, &DECK_DEFAULTS);
+
+  // The hand and challenge benchmarks start from the first deck, dealt in file order, after player 1 played the
+  // first card of the hand as a lie about its value.
+  Deck first = tableDeck(&decks, 0);
+  initGameState(&bench.state, first.kinds, first.size, NULL);
+  bench.player = bench.state.players[0];
+  int played = handFirst(&bench.state.players[0].hand);
+  if (played >= 0)
+  {
+    Action lie = {ACTION_PLAY, cardValue(played), cardSpice(played), cardValue(played) % CARD_VALUES + 1,
+                  cardSpice(played), 0};
+    MoveUndo undo;
+    applyMove(&bench.state, &lie, &undo);
+  }
+
+  // The session benchmarks replay a game of every deck, typed into a temporary file.
+  bench.script = tmpfile();
+
+  int count = 0;
+  measure("load_config", benchLoadConfig, &bench, samples, times, &results[count++]);
+  measure("deal", benchDeal, &bench, samples, times, &results[count++]);
+  measure("hand_order", benchHandOrder, &bench, samples, times, &results[count++]);
+  measure("play_card", benchPlayCard, &bench, samples, times, &results[count++]);
+  if (played >= 0)
+  {
+    measure("challenge", benchChallenge, &bench, samples, times, &results[count++]);
+  }
+  measure("generate", benchGenerate, &bench, samples, times, &results[count++]);
+  measure("shuffle", benchShuffle, &bench, samples, times, &results[count++]);
+
+  for (bench.deck = 0; bench.deck < decks.count; bench.deck++)
+  {
+    const char *path = decks.entries[bench.deck].path;
+    const char *slash = strrchr(path, '/');
+    char name[BENCH_NAME_SIZE];
+    snprintf(name, sizeof(name), "game/%s", slash ? slash + 1 : path);
+    measure(name, benchGame, &bench, samples, times, &results[count++]);
+  }
+  for (bench.deck = 0; bench.deck < decks.count; bench.deck++)
+  {
+    Deck deck = tableDeck(&decks, bench.deck);
+    if (!bench.script || writeSession(&deck, bench.script, &bench.machine) != 0)
+    {
+      continue;
+    }
+    const char *path = decks.entries[bench.deck].path;
+    const char *slash = strrchr(path, '/');
+    char name[BENCH_NAME_SIZE];
+    snprintf(name, sizeof(name), "session/%s", slash ? slash + 1 : path);
+    measure(name, benchSession, &bench, samples, times, &results[count++]);
+  }
+
+  printf("%-28s %12s %8s %12s %12s %12s %12s %12s %14s\n", "benchmark", "ops/sample", "samples", "min ns/op",
+         "p50 ns/op", "p90 ns/op", "p99 ns/op", "max ns/op", "p50 ops/s");
+  for (int r = 0; r < count; r++)
+  {
+    const BenchResult *result = &results[r];
+    printf("%-28s %12lld %8d %12.1f %12.1f %12.1f %12.1f %12.1f %14.0f\n", result->name, result->operations,
+           result->samples, result->min, result->p50, result->p90, result->p99, result->max,
+           result->p50 > 0 ? 1e9 / result->p50 : 0.0);
+  }
+
+  int failed = json_path && writeJson(json_path, results, count) != 0;
+  if (failed)
+  {
+    printf("Error: Cannot write file: %s\n", json_path);
+  }
+
+  if (bench.script)
+  {
+    fclose(bench.script);
+  }
+  free(bench.kinds);
+  free(bench.reader);
+  free(times);
+  free(results);
+  freeDeckTable(&decks);
+  return failed ? 2 : 0;
+}
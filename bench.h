@@ -0,0 +1,19 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Benchmark suite of "Entertaining Spice Pretending".
+//
+// Measures loading configuration files, dealing, listing a hand in sorted order, playing a card, resolving a
+// challenge, generating and shuffling decks, a typed session of the interactive game and complete games on every
+// deck of a configuration directory, and reports percentiles per benchmark.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef BENCH_H
+#define BENCH_H
+
+int runBenchmarks(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,344 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Checkpoints of games of "Entertaining Spice Pretending" in progress.
+//
+// Loading maps the file read-only and checks every record once, so restoring a game is a copy of its record into a
+// turn machine and of its draw pile into the buffer the game keeps its cards in. Writing goes through a buffered
+// stream into "<path>.tmp", which is flushed to disk and renamed over the checkpoint when it is finished, and the
+// directory is flushed after the rename.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "config.h"
+
+// "ESPK" in the byte order of a little-endian machine. A file written on a machine of the other byte order does
+// not match and is rejected as invalid.
+#define CHECKPOINT_MAGIC 0x4B505345u
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_TEMPORARY_SUFFIX ".tmp"
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Rounds a length up to the next multiple of 8 bytes, the alignment of the parts of a checkpoint file.
+/// @param length The length in bytes.
+/// @return The padded length.
+static size_t paddedLength(size_t length)
+{
+  return (length + 7) & ~(size_t)7;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks that a record describes a game the turn machine can continue.
+/// @param record A pointer to the record.
+/// @return 1 if the record is valid; 0 otherwise.
+static int validRecord(const CheckpointRecord *record)
+{
+  if (record->seat < 0 || record->seat > 1)
+  {
+    return 0;
+  }
+  for (int seat = 0; seat < 2; seat++)
+  {
+    uint32_t hand_size = 0;
+    for (int index = 0; index < CARD_KINDS; index++)
+    {
+      hand_size += record->hands[seat][index];
+    }
+    if (hand_size > UINT16_MAX || (record->has_played[seat] != 0 && record->has_played[seat] != 1))
+    {
+      return 0;
+    }
+  }
+
+  const uint8_t *pile = checkpointPile(record);
+  for (int i = 0; i < record->pile_count; i++)
+  {
+    if (pile[i] >= CARD_KINDS)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks the header and every record of a mapped checkpoint file and collects the records.
+/// @param checkpoint A pointer to the checkpoint with its data and size set.
+/// @return CONFIG_OK; CONFIG_INVALID_FILE if the file is not a complete checkpoint; CONFIG_OUT_OF_MEMORY.
+static int indexCheckpoint(Checkpoint *checkpoint)
+{
+  const uint8_t *data = checkpoint->data;
+  const CheckpointHeader *header = checkpoint->data;
+  if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION || header->source_length == 0 ||
+      header->source_length > checkpoint->size - sizeof(CheckpointHeader) ||
+      data[sizeof(CheckpointHeader) + header->source_length - 1] != '\0' ||
+      header->count > checkpoint->size / sizeof(CheckpointRecord))
+  {
+    return CONFIG_INVALID_FILE;
+  }
+
+  checkpoint->source = (const char *)(data + sizeof(CheckpointHeader));
+  checkpoint->records = malloc((header->count + 1) * sizeof(CheckpointRecord *));
+  if (!checkpoint->records)
+  {
+    return CONFIG_OUT_OF_MEMORY;
+  }
+
+  size_t offset = sizeof(CheckpointHeader) + paddedLength(header->source_length);
+  for (uint32_t i = 0; i < header->count; i++)
+  {
+    const CheckpointRecord *record = (const CheckpointRecord *)(data + offset);
+    if (offset + sizeof(CheckpointRecord) > checkpoint->size || record->pile_count < 0 ||
+        (size_t)record->pile_count > checkpoint->size - offset - sizeof(CheckpointRecord) || !validRecord(record))
+    {
+      return CONFIG_INVALID_FILE;
+    }
+    checkpoint->records[i] = record;
+    offset += sizeof(CheckpointRecord) + paddedLength((size_t)record->pile_count);
+  }
+  if (offset != checkpoint->size)
+  {
+    return CONFIG_INVALID_FILE;
+  }
+
+  checkpoint->count = (int)header->count;
+  return CONFIG_OK;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Maps a checkpoint file into memory and checks it.
+/// @param path The path of the checkpoint file.
+/// @param checkpoint A pointer to the checkpoint to fill in, which has to be closed with closeCheckpoint on success.
+/// @return CONFIG_OK; CONFIG_CANNOT_OPEN if the file cannot be opened; CONFIG_INVALID_FILE if it is not a valid
+/// checkpoint; CONFIG_OUT_OF_MEMORY.
+int loadCheckpoint(const char *path, Checkpoint *checkpoint)
+{
+  memset(checkpoint, 0, sizeof(*checkpoint));
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return CONFIG_CANNOT_OPEN;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || (size_t)info.st_size < sizeof(CheckpointHeader))
+  {
+    close(fd);
+    return CONFIG_INVALID_FILE;
+  }
+  void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    return CONFIG_INVALID_FILE;
+  }
+
+  checkpoint->data = data;
+  checkpoint->size = (size_t)info.st_size;
+  int status = indexCheckpoint(checkpoint);
+  if (status != CONFIG_OK)
+  {
+    closeCheckpoint(checkpoint);
+  }
+  return status;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Unmaps a checkpoint file. The records of the checkpoint must not be used afterwards.
+/// @param checkpoint A pointer to the checkpoint.
+void closeCheckpoint(Checkpoint *checkpoint)
+{
+  if (checkpoint->data)
+  {
+    munmap(checkpoint->data, checkpoint->size);
+  }
+  free(checkpoint->records);
+  memset(checkpoint, 0, sizeof(*checkpoint));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Sets up a turn machine with a game of a checkpoint, waiting for a command of the player to move.
+/// @param record A pointer to the record of the game.
+/// @param pile A buffer of at least pile_count bytes receiving the draw pile. It must stay valid while the game is
+/// played.
+/// @param machine A pointer to the turn machine to set up.
+void restoreGame(const CheckpointRecord *record, uint8_t *pile, TurnMachine *machine)
+{
+  static const Hand EMPTY_HAND;
+  memset(machine, 0, sizeof(*machine));
+  GameState *state = &machine->state;
+  for (int seat = 0; seat < 2; seat++)
+  {
+    Player *player = &state->players[seat];
+    for (int index = 0; index < CARD_KINDS; index++)
+    {
+      player->hand.counts[index] = record->hands[seat][index];
+      player->hand.size += record->hands[seat][index];
+      player->hand.present |= (uint32_t)(record->hands[seat][index] != 0) << index;
+    }
+    player->score = record->scores[seat];
+    player->has_played = record->has_played[seat];
+    player->latest_card.value = record->latest_values[seat];
+    player->latest_card.spice = record->latest_spices[seat];
+    player->claimed_card.value = record->claimed_values[seat];
+    player->claimed_card.spice = record->claimed_spices[seat];
+    startTracker(&machine->trackers[seat], record->unseen[seat], &EMPTY_HAND);
+  }
+
+  memcpy(pile, checkpointPile(record), (size_t)record->pile_count);
+  state->draw_pile.kinds = pile;
+  state->draw_pile.top = 0;
+  state->draw_pile.size = record->pile_count;
+  state->cards_played_this_round = record->cards_played_this_round;
+  state->latest_card_number = record->latest_card_number;
+  state->latest_card_spice = record->latest_card_spice;
+  state->seat = record->seat;
+  machine->expect = EXPECT_COMMAND;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes bytes followed by zeros up to the next multiple of 8 bytes.
+/// @param writer A pointer to the writer.
+/// @param bytes The bytes to write.
+/// @param length The number of bytes.
+static void writePadded(CheckpointWriter *writer, const void *bytes, size_t length)
+{
+  static const uint8_t ZEROS[8];
+  if (fwrite(bytes, 1, length, writer->file) != length ||
+      fwrite(ZEROS, 1, paddedLength(length) - length, writer->file) != paddedLength(length) - length)
+  {
+    writer->failed = 1;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Starts writing a checkpoint. The games are written to a temporary file next to the checkpoint, which replaces
+/// it in finishCheckpoint.
+/// @param path The path of the checkpoint file.
+/// @param source The path of the configuration file the games were dealt from, or "".
+/// @return A pointer to the writer, or NULL if the temporary file cannot be created or there is not enough memory.
+CheckpointWriter *createCheckpoint(const char *path, const char *source)
+{
+  CheckpointWriter *writer = calloc(1, sizeof(CheckpointWriter));
+  size_t path_length = strlen(path);
+  if (!writer || !(writer->path = malloc(path_length + 1)) ||
+      !(writer->temporary_path = malloc(path_length + sizeof(CHECKPOINT_TEMPORARY_SUFFIX))))
+  {
+    if (writer)
+    {
+      free(writer->path);
+      free(writer);
+    }
+    return NULL;
+  }
+  memcpy(writer->path, path, path_length + 1);
+  memcpy(writer->temporary_path, path, path_length);
+  memcpy(writer->temporary_path + path_length, CHECKPOINT_TEMPORARY_SUFFIX, sizeof(CHECKPOINT_TEMPORARY_SUFFIX));
+
+  writer->file = fopen(writer->temporary_path, "wb");
+  if (!writer->file)
+  {
+    free(writer->temporary_path);
+    free(writer->path);
+    free(writer);
+    return NULL;
+  }
+
+  CheckpointHeader header = {CHECKPOINT_MAGIC, CHECKPOINT_VERSION, 0, (uint32_t)strlen(source) + 1};
+  writePadded(writer, &header, sizeof(header));
+  writePadded(writer, source, header.source_length);
+  return writer;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds a game that waits for a command to a checkpoint.
+/// @param writer A pointer to the writer.
+/// @param machine A pointer to the turn machine of the game, which must expect EXPECT_COMMAND.
+/// @param deck_counts The number of cards of each kind in the deck of the game.
+/// @param id The number of the game for whoever plays it.
+/// @param rng The random number generator state of whoever plays the game.
+void addCheckpointGame(CheckpointWriter *writer, const TurnMachine *machine, const uint16_t *deck_counts, uint64_t id,
+                       uint64_t rng)
+{
+  const GameState *state = &machine->state;
+  CheckpointRecord record;
+  memset(&record, 0, sizeof(record));
+  record.id = id;
+  record.rng = rng;
+  for (int seat = 0; seat < 2; seat++)
+  {
+    const Player *player = &state->players[seat];
+    record.scores[seat] = player->score;
+    record.has_played[seat] = player->has_played;
+    record.latest_values[seat] = player->latest_card.value;
+    record.latest_spices[seat] = player->latest_card.spice;
+    record.claimed_values[seat] = player->claimed_card.value;
+    record.claimed_spices[seat] = player->claimed_card.spice;
+    for (int index = 0; index < CARD_KINDS; index++)
+    {
+      record.hands[seat][index] = player->hand.counts[index];
+      record.unseen[seat][index] = (uint16_t)machine->trackers[seat].unseen[index];
+    }
+  }
+  memcpy(record.deck_counts, deck_counts, sizeof(record.deck_counts));
+  record.cards_played_this_round = state->cards_played_this_round;
+  record.latest_card_number = state->latest_card_number;
+  record.latest_card_spice = state->latest_card_spice;
+  record.seat = state->seat;
+  record.pile_count = pileCount(&state->draw_pile);
+
+  writePadded(writer, &record, sizeof(record));
+  writePadded(writer, state->draw_pile.kinds + state->draw_pile.top, (size_t)record.pile_count);
+  writer->count++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds a game of a loaded checkpoint to a new checkpoint unchanged.
+/// @param writer A pointer to the writer.
+/// @param record A pointer to the record of the game.
+void copyCheckpointGame(CheckpointWriter *writer, const CheckpointRecord *record)
+{
+  writePadded(writer, record, sizeof(*record));
+  writePadded(writer, checkpointPile(record), (size_t)record->pile_count);
+  writer->count++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Completes a checkpoint: writes the number of games, flushes the temporary file to disk, renames it to the path of
+/// the checkpoint and flushes the directory, so that the rename survives a crash. The writer is freed.
+/// @param writer A pointer to the writer.
+/// @return 0 if the checkpoint was replaced; 1 if writing failed, in which case the previous checkpoint is kept, or if
+///         the directory could not be flushed after the rename.
+int finishCheckpoint(CheckpointWriter *writer)
+{
+  int failed = writer->failed || fseek(writer->file, (long)offsetof(CheckpointHeader, count), SEEK_SET) != 0 ||
+               fwrite(&writer->count, sizeof(writer->count), 1, writer->file) != 1 || fflush(writer->file) != 0 ||
+               fsync(fileno(writer->file)) != 0;
+  failed = (fclose(writer->file) != 0) | failed;
+  if (failed || rename(writer->temporary_path, writer->path) != 0)
+  {
+    remove(writer->temporary_path);
+    failed = 1;
+  }
+  else
+  {
+    failed = syncDirectory(writer->path) != 0;
+  }
+
+  free(writer->temporary_path);
+  free(writer->path);
+  free(writer);
+  return failed;
+}
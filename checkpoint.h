@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Checkpoints of games of "Entertaining Spice Pretending" in progress.
+//
+// A checkpoint file holds any number of games that wait for a command, each with both hands, the draw pile, the
+// scores, the latest played and claimed cards, the round counter and the cards each player has not seen yet. The
+// records have a fixed layout in the byte order of the machine, so a file is mapped into memory and its games are
+// restored without parsing. Files are written to a temporary file that replaces the checkpoint only once it is
+// complete, so a crash while writing leaves the previous checkpoint intact.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "turn.h"
+
+// File layout: a CheckpointHeader, the path of the configuration file the games were dealt from, then count
+// records, each a CheckpointRecord followed by pile_count kind index bytes of the draw pile from its top. The path
+// and every record are padded with zeros to a multiple of 8 bytes.
+typedef struct CheckpointHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t count;
+  uint32_t source_length;
+} CheckpointHeader;
+
+// One game waiting for a command of the player at seat. unseen are the cards each player has not seen, which
+// restore their card trackers. id and rng belong to whoever plays the game, for example a session of the server.
+typedef struct CheckpointRecord
+{
+  uint64_t id;
+  uint64_t rng;
+  int32_t scores[2];
+  int32_t has_played[2];
+  int32_t latest_values[2];
+  int32_t claimed_values[2];
+  int32_t cards_played_this_round;
+  int32_t latest_card_number;
+  int32_t latest_card_spice;
+  int32_t seat;
+  int32_t pile_count;
+  char latest_spices[2];
+  char claimed_spices[2];
+  uint16_t deck_counts[CARD_KINDS];
+  uint16_t hands[2][CARD_KINDS];
+  uint16_t unseen[2][CARD_KINDS];
+} CheckpointRecord;
+
+typedef struct Checkpoint
+{
+  void *data;
+  size_t size;
+  const char *source;
+  int count;
+  const CheckpointRecord **records;
+} Checkpoint;
+
+typedef struct CheckpointWriter
+{
+  FILE *file;
+  char *path;
+  char *temporary_path;
+  uint32_t count;
+  int failed;
+} CheckpointWriter;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the draw pile of a record, which follows the record in the file.
+/// @param record A pointer to the record.
+/// @return The kind indices of the cards from the top of the pile.
+static inline const uint8_t *checkpointPile(const CheckpointRecord *record)
+{
+  return (const uint8_t *)(record + 1);
+}
+
+int loadCheckpoint(const char *path, Checkpoint *checkpoint);
+void closeCheckpoint(Checkpoint *checkpoint);
+void restoreGame(const CheckpointRecord *record, uint8_t *pile, TurnMachine *machine);
+CheckpointWriter *createCheckpoint(const char *path, const char *source);
+void addCheckpointGame(CheckpointWriter *writer, const TurnMachine *machine, const uint16_t *deck_counts, uint64_t id,
+                       uint64_t rng);
+void copyCheckpointGame(CheckpointWriter *writer, const CheckpointRecord *record);
+int finishCheckpoint(CheckpointWriter *writer);
+
+#endif
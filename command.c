@@ -0,0 +1,97 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Command parsing of the interactive game of "Entertaining Spice Pretending".
+//
+// Syntax errors are not reported here but passed on in the command, since the turn machine decides how the turn goes
+// on after them. The end of the input is read as "quit" wherever it happens, so a script that stops in the middle of
+// a turn ends the game instead of waiting for more input.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdio.h>
+#include <strings.h>
+
+#include "command.h"
+#include "stats.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads the two cards of a "play" command from the player's input. The end of the input is read as "quit".
+/// @param input A pointer to the reader of the commands.
+/// @param command A pointer to the command receiving the cards, or the error that prevented reading them.
+void readPlayCards(CommandReader *input, TurnCommand *command)
+{
+  char hand_card_input[TOKEN_SIZE];
+  char claimed_card_input[TOKEN_SIZE];
+  Action *action = &command->action;
+  command->command = COMMAND_PLAY;
+  command->has_cards = 1;
+  action->type = ACTION_PLAY;
+
+  STATS_START(input_started);
+  if (readToken(input, hand_card_input) == EOF || readToken(input, claimed_card_input) == EOF)
+  {
+    command->command = COMMAND_QUIT;
+    command->error = TURN_OK;
+    return;
+  }
+
+  if (parseCard(hand_card_input, &action->hand_value, &action->hand_spice) != 0 ||
+      parseCard(claimed_card_input, &action->claimed_value, &action->claimed_spice) != 0)
+  {
+    command->error = TURN_CARD_FORMAT;
+    return;
+  }
+  STATS_STOP(PHASE_INPUT, input_started);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads the next command of a human player, or the cards of a "play" command if the game expects them.
+/// The end of the input is read as "quit".
+/// @param input A pointer to the reader of the commands.
+/// @param expect The input the game expects.
+/// @param command A pointer to the command to fill in.
+/// @param challenge_type A buffer of TOKEN_SIZE characters receiving the challenge type as it was typed, which is
+/// repeated when the challenge is resolved.
+void readCommand(CommandReader *input, TurnExpect expect, TurnCommand *command, char *challenge_type)
+{
+  TurnCommand empty = {COMMAND_UNKNOWN, TURN_OK, 0, {ACTION_DRAW, 0, '\0', 0, '\0', 0}};
+  *command = empty;
+  if (expect == EXPECT_CARDS)
+  {
+    readPlayCards(input, command);
+    return;
+  }
+
+  char token[TOKEN_SIZE];
+  STATS_START(input_started);
+  if (readToken(input, token) == EOF)
+  {
+    command->command = COMMAND_QUIT;
+    return;
+  }
+  STATS_STOP(PHASE_INPUT, input_started);
+
+  command->command = findCommand(token);
+  if (command->command == COMMAND_CHALLENGE)
+  {
+    challenge_type[0] = '\0';
+    readToken(input, challenge_type);
+    if (strcasecmp(challenge_type, "value") != 0 && strcasecmp(challenge_type, "spice") != 0)
+    {
+      command->error = TURN_CHALLENGE_TYPE;
+    }
+    command->action.type = ACTION_CHALLENGE;
+    command->action.challenge_value = strcasecmp(challenge_type, "value") == 0;
+  }
+  else if (command->command == COMMAND_QUIT)
+  {
+    char extra_input[TOKEN_SIZE];
+    if (readToken(input, extra_input) != EOF)
+    {
+      command->error = TURN_WRONG_PARAMETERS;
+    }
+  }
+}
@@ -0,0 +1,23 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Command parsing of the interactive game of "Entertaining Spice Pretending".
+//
+// Turns the tokens of a command reader into the commands of the turn machine, exactly as a player types them: a
+// command word, the challenge type of "challenge", and the two cards of "play", which may follow on the same line or
+// be typed again after they were rejected.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "input.h"
+#include "turn.h"
+
+void readPlayCards(CommandReader *input, TurnCommand *command);
+void readCommand(CommandReader *input, TurnExpect expect, TurnCommand *command, char *challenge_type);
+
+#endif
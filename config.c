@@ -0,0 +1,718 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Loading of configuration files for "Entertaining Spice Pretending".
+//
+// The scanner reproduces exactly what the former fgets/sscanf("%d_%c") parser accepted: lines are consumed in
+// chunks of at most 9 characters, leading whitespace and a sign are allowed before the value, anything after the
+// spice character is ignored, and the offending chunk is reported for an invalid card.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#define CONFIG_HEADER "ESP\n"
+#define CONFIG_HEADER_LENGTH 4
+
+// Line starting the block of accumulated scores at the end of a configuration file. The deck ends before it.
+#define CONFIG_SCORES "SCORES\n"
+#define CONFIG_SCORES_LENGTH 7
+
+// First line of a rule file, and the largest number any of its rules may have.
+#define RULES_HEADER "RULES\n"
+#define RULES_HEADER_LENGTH 6
+#define RULES_LIMIT 1000
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads a whole file into memory with a single open. The size reported by the file system is only a hint, so
+/// the buffer grows if the file turns out to be longer.
+/// @param path The path to the file.
+/// @param length A pointer to the variable receiving the number of bytes read.
+/// @param data A pointer to the variable receiving the buffer, which the caller has to free.
+/// @return CONFIG_OK; CONFIG_CANNOT_OPEN if the file cannot be opened; CONFIG_INVALID_FILE if it cannot be read,
+/// for example because it is a directory; CONFIG_OUT_OF_MEMORY.
+static int readFile(const char *path, size_t *length, char **data)
+{
+  FILE *file = fopen(path, "rb");
+  if (!file)
+  {
+    return CONFIG_CANNOT_OPEN;
+  }
+
+  size_t capacity = 4096;
+  if (fseek(file, 0, SEEK_END) == 0)
+  {
+    long size = ftell(file);
+    if (size >= 0)
+    {
+      capacity = (size_t)size + 1;
+    }
+    rewind(file);
+  }
+
+  char *buffer = malloc(capacity);
+  if (!buffer)
+  {
+    capacity = 4096;
+    buffer = malloc(capacity);
+  }
+  size_t used = 0;
+  size_t received = 0;
+
+  while (buffer && (received = fread(buffer + used, 1, capacity - used, file)) > 0)
+  {
+    used += received;
+    if (used == capacity)
+    {
+      capacity *= 2;
+      char *grown = realloc(buffer, capacity);
+      if (!grown)
+      {
+        free(buffer);
+      }
+      buffer = grown;
+    }
+  }
+
+  int failed = ferror(file);
+  fclose(file);
+  if (!buffer)
+  {
+    return CONFIG_OUT_OF_MEMORY;
+  }
+  if (failed)
+  {
+    free(buffer);
+    return CONFIG_INVALID_FILE;
+  }
+
+  *length = used;
+  *data = buffer;
+  return CONFIG_OK;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a character counts as whitespace for scanf.
+/// @param character The character.
+/// @return 1 for whitespace; 0 otherwise.
+static int isScanSpace(char character)
+{
+  return character == ' ' || (character >= '\t' && character <= '\r');
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Parses one chunk of a card line in the format "N_s".
+/// @param line The chunk, terminated by '\0'.
+/// @return The kind index of the card, or -1 if the chunk is not a valid card.
+static int parseCardLine(const char *line)
+{
+  const char *current = line;
+  while (isScanSpace(*current))
+  {
+    current++;
+  }
+
+  int negative = *current == '-';
+  if (*current == '-' || *current == '+')
+  {
+    current++;
+  }
+  if (*current < '0' || *current > '9')
+  {
+    return -1;
+  }
+
+  int value = 0;
+  while (*current >= '0' && *current <= '9')
+  {
+    value = value * 10 + (*current++ - '0');
+  }
+
+  if (*current != '_' || current[1] == '\0')
+  {
+    return -1;
+  }
+  return cardIndex(negative ? -value : value, current[1]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Finds the end of the deck of a configuration file, which is the start of its score block if it has one.
+/// @param data The content of the file, starting with the header.
+/// @param length The number of bytes in data.
+/// @return The number of bytes before the score block, or length if there is none.
+static size_t deckLength(const char *data, size_t length)
+{
+  const char *line_end = memchr(data, '\n', length);
+  while (line_end)
+  {
+    size_t line = (size_t)(line_end - data) + 1;
+    if (length - line >= CONFIG_SCORES_LENGTH && memcmp(data + line, CONFIG_SCORES, CONFIG_SCORES_LENGTH) == 0)
+    {
+      return line;
+    }
+    line_end = memchr(data + line, '\n', length - line);
+  }
+  return length;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks the header and parses all cards of a configuration file that has been read into memory.
+/// @param data The content of the file.
+/// @param length The number of bytes in data.
+/// @param kinds The array receiving the kind index of every card, with room for length / 3 + 1 cards.
+/// @param size A pointer to the variable receiving the number of cards.
+/// @param invalid_line A buffer of CONFIG_LINE_SIZE characters receiving the offending line of an invalid card.
+/// @return CONFIG_OK; CONFIG_INVALID_FILE; CONFIG_INVALID_CARD; CONFIG_EMPTY.
+static int scanConfig(const char *data, size_t length, uint8_t *kinds, int *size, char *invalid_line)
+{
+  if (length < CONFIG_HEADER_LENGTH || memcmp(data, CONFIG_HEADER, CONFIG_HEADER_LENGTH) != 0)
+  {
+    return CONFIG_INVALID_FILE;
+  }
+
+  int count = 0;
+  size_t position = CONFIG_HEADER_LENGTH;
+  length = deckLength(data, length);
+
+  while (position < length)
+  {
+    char line[CONFIG_LINE_SIZE];
+    size_t chunk = 0;
+    while (chunk < CONFIG_LINE_SIZE - 1 && position < length)
+    {
+      line[chunk++] = data[position++];
+      if (line[chunk - 1] == '\n')
+      {
+        break;
+      }
+    }
+    line[chunk] = '\0';
+
+    int index = parseCardLine(line);
+    if (index < 0)
+    {
+      memcpy(invalid_line, line, chunk + 1);
+      return CONFIG_INVALID_CARD;
+    }
+    kinds[count++] = (uint8_t)index;
+  }
+
+  *size = count;
+  return count > 0 ? CONFIG_OK : CONFIG_EMPTY;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Loads the deck of a configuration file in a single pass over the file.
+/// Nothing is printed; errors are reported by the return value and can be printed with printConfigError.
+/// @param config_path The path to the configuration file.
+/// @param deck A pointer to the deck receiving the cards in file order; deck->kinds has to be freed by the caller.
+/// @param invalid_line A buffer of CONFIG_LINE_SIZE characters receiving the offending line of an invalid card.
+/// @return CONFIG_OK if the deck was loaded; otherwise one of the CONFIG error codes.
+int loadConfig(const char *config_path, Deck *deck, char *invalid_line)
+{
+  size_t length = 0;
+  char *data = NULL;
+  int status = readFile(config_path, &length, &data);
+  if (status != CONFIG_OK)
+  {
+    return status;
+  }
+
+  deck->kinds = malloc(length / 3 + 1);
+  deck->size = 0;
+  status = deck->kinds ? scanConfig(data, length, deck->kinds, &deck->size, invalid_line) : CONFIG_OUT_OF_MEMORY;
+  free(data);
+
+  if (status != CONFIG_OK)
+  {
+    free(deck->kinds);
+    deck->kinds = NULL;
+  }
+  return status;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the error message of a failed loadConfig or saveScores call.
+/// @param status The status returned by loadConfig or saveScores.
+/// @param config_path The path to the configuration file.
+/// @param invalid_line The offending line of a CONFIG_INVALID_CARD error.
+void printConfigError(int status, const char *config_path, const char *invalid_line)
+{
+  switch (status)
+  {
+    case CONFIG_CANNOT_OPEN:
+      printf("Error: Cannot open file: %s\n", config_path);
+      break;
+    case CONFIG_INVALID_FILE:
+      printf("Error: Invalid file: %s\n", config_path);
+      break;
+    case CONFIG_INVALID_CARD:
+      printf("Error: Invalid card format: %s", invalid_line);
+      break;
+    case CONFIG_OUT_OF_MEMORY:
+      printf("Error: Out of memory\n");
+      break;
+    case CONFIG_CANNOT_WRITE:
+      printf("Error: Cannot write file: %s\n", config_path);
+      break;
+    default:
+      break;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Maps a loadConfig status to the exit code of the program.
+/// @param status The status returned by loadConfig or saveScores.
+/// @return 0 for CONFIG_OK; 2 if the file cannot be opened or written; 3 for every other error.
+int configExitCode(int status)
+{
+  return status == CONFIG_OK ? 0 : status == CONFIG_CANNOT_OPEN || status == CONFIG_CANNOT_WRITE ? 2 : 3;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds the totals of a score block to the given totals. Lines that are not part of the format are ignored.
+/// @param block The score block, starting with its CONFIG_SCORES line.
+/// @param length The number of bytes in block.
+/// @param totals A pointer to the totals to add to.
+/// @return CONFIG_OK; CONFIG_OUT_OF_MEMORY.
+static int addScoreBlock(const char *block, size_t length, ScoreTotals *totals)
+{
+  char *text = malloc(length + 1);
+  if (!text)
+  {
+    return CONFIG_OUT_OF_MEMORY;
+  }
+  memcpy(text, block, length);
+  text[length] = '\0';
+
+  for (char *line = text; line; )
+  {
+    char *line_end = strchr(line, '\n');
+    if (line_end)
+    {
+      *line_end = '\0';
+    }
+
+    long long first = 0;
+    long long second = 0;
+    if (sscanf(line, "games %lld", &first) == 1)
+    {
+      totals->games += first;
+    }
+    else if (sscanf(line, "wins %lld %lld", &first, &second) == 2)
+    {
+      totals->wins[0] += first;
+      totals->wins[1] += second;
+    }
+    else if (sscanf(line, "ties %lld", &first) == 1)
+    {
+      totals->ties += first;
+    }
+    else if (sscanf(line, "points %lld %lld", &first, &second) == 2)
+    {
+      totals->points[0] += first;
+      totals->points[1] += second;
+    }
+    line = line_end ? line_end + 1 : NULL;
+  }
+
+  free(text);
+  return CONFIG_OK;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Flushes the directory entries of the directory holding a file to the disk, so that a file renamed into it is
+/// still there after a crash.
+/// @param path The path to the file.
+/// @return 0 on success; 1 if the directory cannot be opened or flushed.
+int syncDirectory(const char *path)
+{
+  const char *slash = strrchr(path, '/');
+  char *directory = slash ? strndup(path, slash == path ? 1 : (size_t)(slash - path)) : strdup(".");
+  int descriptor = directory ? open(directory, O_RDONLY) : -1;
+  int failed = descriptor < 0 || fsync(descriptor) != 0;
+  if (descriptor >= 0)
+  {
+    close(descriptor);
+  }
+  free(directory);
+  return failed;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds the results to the score block of a configuration file while the caller holds the lock of the file.
+/// @param config_path The path to the configuration file.
+/// @param results A pointer to the results to add.
+/// @return CONFIG_OK; CONFIG_CANNOT_OPEN; CONFIG_INVALID_FILE; CONFIG_OUT_OF_MEMORY; CONFIG_CANNOT_WRITE.
+static int updateScores(const char *config_path, const ScoreTotals *results)
+{
+  size_t length = 0;
+  char *data = NULL;
+  int status = readFile(config_path, &length, &data);
+  if (status != CONFIG_OK)
+  {
+    return status;
+  }
+  if (length < CONFIG_HEADER_LENGTH || memcmp(data, CONFIG_HEADER, CONFIG_HEADER_LENGTH) != 0)
+  {
+    free(data);
+    return CONFIG_INVALID_FILE;
+  }
+
+  size_t deck_length = deckLength(data, length);
+  ScoreTotals totals = *results;
+  char *temp_path = malloc(strlen(config_path) + 8);
+  if (!temp_path || addScoreBlock(data + deck_length, length - deck_length, &totals) != CONFIG_OK)
+  {
+    free(temp_path);
+    free(data);
+    return CONFIG_OUT_OF_MEMORY;
+  }
+
+  sprintf(temp_path, "%s.XXXXXX", config_path);
+  int descriptor = mkstemp(temp_path);
+  FILE *file = descriptor >= 0 ? fdopen(descriptor, "wb") : NULL;
+  int failed = !file;
+  if (file)
+  {
+    struct stat info;
+    if (stat(config_path, &info) == 0)
+    {
+      fchmod(descriptor, info.st_mode & 07777);
+    }
+
+    failed |= fwrite(data, 1, deck_length, file) != deck_length;
+    if (data[deck_length - 1] != '\n')
+    {
+      failed |= fputc('\n', file) == EOF;
+    }
+    failed |= fprintf(file, CONFIG_SCORES "games %lld\nwins %lld %lld\nties %lld\npoints %lld %lld\n", totals.games,
+                      totals.wins[0], totals.wins[1], totals.ties, totals.points[0], totals.points[1]) < 0;
+    failed |= fflush(file) != 0 || fsync(descriptor) != 0;
+    failed |= fclose(file) != 0;
+    failed = failed || rename(temp_path, config_path) != 0;
+    failed = failed || syncDirectory(config_path) != 0;
+  }
+  else if (descriptor >= 0)
+  {
+    close(descriptor);
+  }
+
+  if (failed && descriptor >= 0)
+  {
+    unlink(temp_path);
+  }
+  free(temp_path);
+  free(data);
+  return failed ? CONFIG_CANNOT_WRITE : CONFIG_OK;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds the results of one or more games to the score block of a configuration file. The deck lines are kept as
+/// they are. The new content is written to a temporary file next to the configuration file, flushed to the disk
+/// and renamed over it, and the directory is flushed as well, so the file is never seen half written, even if the
+/// program is stopped in between. The whole update holds an exclusive lock on the configuration file, so processes
+/// saving to the same file at once add up their results instead of overwriting each other. The rename of another
+/// process replaces the file that was locked, so the lock is taken again until it is held on the current file.
+/// @param config_path The path to the configuration file.
+/// @param results A pointer to the results to add.
+/// @return CONFIG_OK; CONFIG_CANNOT_OPEN; CONFIG_INVALID_FILE; CONFIG_OUT_OF_MEMORY; CONFIG_CANNOT_WRITE.
+int saveScores(const char *config_path, const ScoreTotals *results)
+{
+  int descriptor = -1;
+  for (;;)
+  {
+    descriptor = open(config_path, O_RDONLY);
+    if (descriptor < 0)
+    {
+      return CONFIG_CANNOT_OPEN;
+    }
+    struct stat locked;
+    struct stat current;
+    if (flock(descriptor, LOCK_EX) != 0 || fstat(descriptor, &locked) != 0)
+    {
+      close(descriptor);
+      return CONFIG_CANNOT_WRITE;
+    }
+    if (stat(config_path, &current) == 0 && current.st_dev == locked.st_dev && current.st_ino == locked.st_ino)
+    {
+      break;
+    }
+    close(descriptor);
+  }
+
+  int status = updateScores(config_path, results);
+  close(descriptor);
+  return status;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Loads a variant of the rules from a rule file. The file starts with a RULES_HEADER line followed by any of the
+/// lines "hand <cards dealt to each player>", "penalty <cards taken for a lost challenge>" and
+/// "bonus <points for emptying the opponent's hand>". Empty lines are skipped, and the rules that are not given keep
+/// their standard value.
+/// @param rules_path The path to the rule file.
+/// @param rules A pointer to the rules to fill in.
+/// @return CONFIG_OK; CONFIG_CANNOT_OPEN; CONFIG_INVALID_FILE for a missing header, an unknown line or a number out
+/// of range; CONFIG_OUT_OF_MEMORY.
+int loadRules(const char *rules_path, Rules *rules)
+{
+  size_t length = 0;
+  char *data = NULL;
+  int status = readFile(rules_path, &length, &data);
+  if (status != CONFIG_OK)
+  {
+    return status;
+  }
+  char *text = realloc(data, length + 1);
+  if (!text)
+  {
+    free(data);
+    return CONFIG_OUT_OF_MEMORY;
+  }
+  text[length] = '\0';
+  if (length < RULES_HEADER_LENGTH || memcmp(text, RULES_HEADER, RULES_HEADER_LENGTH) != 0)
+  {
+    free(text);
+    return CONFIG_INVALID_FILE;
+  }
+
+  Rules loaded = {STANDARD_HAND_SIZE, STANDARD_PENALTY_CARDS, STANDARD_EMPTY_HAND_BONUS};
+  status = CONFIG_OK;
+  for (char *line = text + RULES_HEADER_LENGTH; line && status == CONFIG_OK; )
+  {
+    char *line_end = strchr(line, '\n');
+    if (line_end)
+    {
+      *line_end = '\0';
+    }
+
+    int number = -1;
+    int used = 0;
+    if (sscanf(line, "hand %d%n", &number, &used) == 1)
+    {
+      loaded.hand_size = number;
+    }
+    else if (sscanf(line, "penalty %d%n", &number, &used) == 1)
+    {
+      loaded.penalty_cards = number;
+    }
+    else if (sscanf(line, "bonus %d%n", &number, &used) == 1)
+    {
+      loaded.empty_hand_bonus = number;
+    }
+    if (*line != '\0' && (line[used] != '\0' || number < 0 || number > RULES_LIMIT))
+    {
+      status = CONFIG_INVALID_FILE;
+    }
+    line = line_end ? line_end + 1 : NULL;
+  }
+
+  free(text);
+  if (status == CONFIG_OK)
+  {
+    *rules = loaded;
+  }
+  return status;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Compares two strings for sorting the paths of a directory.
+/// @param first A pointer to the first string.
+/// @param second A pointer to the second string.
+/// @return The result of strcmp.
+static int comparePaths(const void *first, const void *second)
+{
+  return strcmp(*(char *const *)first, *(char *const *)second);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Loads a configuration file and appends its deck to a deck table. The cards of all decks share one array.
+/// @param table A pointer to the table, which has to be zero-initialized before its first use.
+/// @param config_path The path to the configuration file; the table keeps its own copy.
+/// @param invalid_line A buffer of CONFIG_LINE_SIZE characters receiving the offending line of an invalid card.
+/// @return CONFIG_OK if the deck was appended; otherwise the error of loadConfig or CONFIG_OUT_OF_MEMORY.
+int appendConfig(DeckTable *table, const char *config_path, char *invalid_line)
+{
+  Deck deck;
+  int status = loadConfig(config_path, &deck, invalid_line);
+  if (status != CONFIG_OK)
+  {
+    return status;
+  }
+
+  if (table->count == table->entry_capacity)
+  {
+    int grown_capacity = table->entry_capacity ? table->entry_capacity * 2 : 64;
+    DeckEntry *grown = realloc(table->entries, sizeof(DeckEntry) * grown_capacity);
+    if (!grown)
+    {
+      free(deck.kinds);
+      return CONFIG_OUT_OF_MEMORY;
+    }
+    table->entries = grown;
+    table->entry_capacity = grown_capacity;
+  }
+
+  if (table->card_count + deck.size > table->card_capacity)
+  {
+    int grown_capacity = table->card_capacity ? table->card_capacity : 1024;
+    while (grown_capacity < table->card_count + deck.size)
+    {
+      grown_capacity *= 2;
+    }
+    uint8_t *grown = realloc(table->kinds, grown_capacity);
+    if (!grown)
+    {
+      free(deck.kinds);
+      return CONFIG_OUT_OF_MEMORY;
+    }
+    table->kinds = grown;
+    table->card_capacity = grown_capacity;
+  }
+
+  char *path = malloc(strlen(config_path) + 1);
+  if (!path)
+  {
+    free(deck.kinds);
+    return CONFIG_OUT_OF_MEMORY;
+  }
+  strcpy(path, config_path);
+
+  memcpy(table->kinds + table->card_count, deck.kinds, deck.size);
+  table->entries[table->count].path = path;
+  table->entries[table->count].first = table->card_count;
+  table->entries[table->count].size = deck.size;
+  table->card_count += deck.size;
+  table->count++;
+  free(deck.kinds);
+  return CONFIG_OK;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a path names a directory that can be read.
+/// @param path The path.
+/// @return 1 for a readable directory; 0 otherwise.
+int isDirectory(const char *path)
+{
+  DIR *handle = opendir(path);
+  if (handle)
+  {
+    closedir(handle);
+  }
+  return handle != NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Appends every configuration file ending in ".txt" in a directory to a deck table, in the order of the file names.
+/// Files that are not valid configurations are skipped and counted in table->skipped.
+/// @param directory The path to the directory.
+/// @param table A pointer to the table, which has to be zero-initialized before its first use.
+/// @return CONFIG_OK; CONFIG_CANNOT_OPEN if the directory cannot be read; CONFIG_OUT_OF_MEMORY.
+int loadConfigDirectory(const char *directory, DeckTable *table)
+{
+  DIR *handle = opendir(directory);
+  if (!handle)
+  {
+    return CONFIG_CANNOT_OPEN;
+  }
+
+  char **paths = NULL;
+  int path_count = 0;
+  int path_capacity = 0;
+  int status = CONFIG_OK;
+  size_t directory_length = strlen(directory);
+  struct dirent *entry;
+
+  while ((entry = readdir(handle)) != NULL)
+  {
+    size_t name_length = strlen(entry->d_name);
+    if (name_length < 4 || strcmp(entry->d_name + name_length - 4, ".txt") != 0)
+    {
+      continue;
+    }
+
+    if (path_count == path_capacity)
+    {
+      path_capacity = path_capacity ? path_capacity * 2 : 64;
+      char **grown = realloc(paths, sizeof(char *) * path_capacity);
+      if (!grown)
+      {
+        status = CONFIG_OUT_OF_MEMORY;
+        break;
+      }
+      paths = grown;
+    }
+
+    char *path = malloc(directory_length + name_length + 2);
+    if (!path)
+    {
+      status = CONFIG_OUT_OF_MEMORY;
+      break;
+    }
+    sprintf(path, "%s/%s", directory, entry->d_name);
+    paths[path_count++] = path;
+  }
+  closedir(handle);
+
+  if (status == CONFIG_OK)
+  {
+    qsort(paths, path_count, sizeof(char *), comparePaths);
+  }
+
+  for (int i = 0; i < path_count; i++)
+  {
+    char invalid_line[CONFIG_LINE_SIZE];
+    int loaded = status == CONFIG_OK ? appendConfig(table, paths[i], invalid_line) : status;
+    if (loaded == CONFIG_OUT_OF_MEMORY)
+    {
+      status = loaded;
+    }
+    else if (loaded != CONFIG_OK)
+    {
+      table->skipped++;
+    }
+    free(paths[i]);
+  }
+  free(paths);
+  return status;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns a view of one deck of a deck table without copying its cards.
+/// @param table A pointer to the table.
+/// @param index The index of the deck.
+/// @return The deck, which stays valid as long as the table is not changed.
+Deck tableDeck(const DeckTable *table, int index)
+{
+  Deck deck = {table->kinds + table->entries[index].first, table->entries[index].size};
+  return deck;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Releases everything owned by a deck table.
+/// @param table A pointer to the table.
+void freeDeckTable(DeckTable *table)
+{
+  for (int i = 0; i < table->count; i++)
+  {
+    free(table->entries[i].path);
+  }
+  free(table->entries);
+  free(table->kinds);
+  memset(table, 0, sizeof(*table));
+}
@@ -0,0 +1,78 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Loading of configuration files for "Entertaining Spice Pretending".
+//
+// A configuration file is read with one open and one read, and its "ESP" header and "N_s" card lines are checked
+// and parsed in a single pass over the buffer. Decks are kept as one kind index byte per card (see cardIndex), and
+// a whole directory of configuration files can be loaded into one deck table. Rule files describe variants of the
+// rules for simulations.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+
+#include "engine.h"
+
+#define CONFIG_OK 0
+#define CONFIG_CANNOT_OPEN 2
+#define CONFIG_INVALID_FILE 3
+#define CONFIG_INVALID_CARD 4
+#define CONFIG_EMPTY 5
+#define CONFIG_OUT_OF_MEMORY 6
+#define CONFIG_CANNOT_WRITE 7
+
+// Size of the buffer receiving the offending line of a CONFIG_INVALID_CARD error.
+#define CONFIG_LINE_SIZE 10
+
+typedef struct Deck
+{
+  uint8_t *kinds;
+  int size;
+} Deck;
+
+typedef struct DeckEntry
+{
+  char *path;
+  int first;
+  int size;
+} DeckEntry;
+
+// Results of any number of games on one deck, as kept in the score block of its configuration file.
+typedef struct ScoreTotals
+{
+  long long games;
+  long long wins[2];
+  long long ties;
+  long long points[2];
+} ScoreTotals;
+
+typedef struct DeckTable
+{
+  DeckEntry *entries;
+  int count;
+  int entry_capacity;
+  uint8_t *kinds;
+  int card_count;
+  int card_capacity;
+  int skipped;
+} DeckTable;
+
+int loadConfig(const char *config_path, Deck *deck, char *invalid_line);
+void printConfigError(int status, const char *config_path, const char *invalid_line);
+int configExitCode(int status);
+int appendConfig(DeckTable *table, const char *config_path, char *invalid_line);
+int isDirectory(const char *path);
+int loadConfigDirectory(const char *directory, DeckTable *table);
+Deck tableDeck(const DeckTable *table, int index);
+void freeDeckTable(DeckTable *table);
+int saveScores(const char *config_path, const ScoreTotals *results);
+int syncDirectory(const char *path);
+int loadRules(const char *rules_path, Rules *rules);
+
+#endif
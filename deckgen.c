@@ -0,0 +1,303 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Random deck generator of "Entertaining Spice Pretending".
+//
+// The alias table is built once per distribution with Vose's method, after which every card costs one splitmix64
+// step: the high half of the random number picks a column and the low half is compared with its threshold.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deckgen.h"
+#include "simulate.h"
+
+// Largest weight of a value or spice, which keeps the products of two weights exact in a double.
+#define MAX_WEIGHT 1000000
+
+const DeckSpec DECK_DEFAULTS = {0, {1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, {1, 1, 1}};
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Parses a comma separated list of weights.
+/// @param text The list.
+/// @param weights The array receiving the weights.
+/// @param count The number of weights the list has to contain.
+/// @return 0 if the list is valid; 1 otherwise.
+static int parseWeights(const char *text, uint32_t *weights, int count)
+{
+  const char *current = text;
+  for (int i = 0; i < count; i++)
+  {
+    char *rest = NULL;
+    long weight = strtol(current, &rest, 10);
+    if (rest == current || weight < 0 || weight > MAX_WEIGHT || *rest != (i + 1 < count ? ',' : '\0'))
+    {
+      return 1;
+    }
+    weights[i] = (uint32_t)weight;
+    current = rest + 1;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Parses one of the options "--generate <cards>", "--values <w1,...,w10>" and "--spices <wc,wp,ww>".
+/// @param argv An array of strings representing the command-line arguments.
+/// @param index A pointer to the index of the option, advanced past its value if it is parsed.
+/// @param end The index of the first argument that is not an option.
+/// @param spec A pointer to the deck specification to change.
+/// @return 0 if the option was parsed; 1 if it is not a deck option or its value is invalid.
+int parseDeckOption(char *argv[], int *index, int end, DeckSpec *spec)
+{
+  if (*index + 1 >= end)
+  {
+    return 1;
+  }
+
+  const char *value = argv[*index + 1];
+  if (strcmp(argv[*index], "--generate") == 0)
+  {
+    char *rest = NULL;
+    long size = strtol(value, &rest, 10);
+    if (*rest != '\0' || size < 1 || size > DECK_MAX_CARDS)
+    {
+      return 1;
+    }
+    spec->size = (int)size;
+  }
+  else if (strcmp(argv[*index], "--values") == 0)
+  {
+    if (parseWeights(value, spec->value_weights, CARD_VALUES) != 0)
+    {
+      return 1;
+    }
+  }
+  else if (strcmp(argv[*index], "--spices") == 0)
+  {
+    if (parseWeights(value, spec->spice_weights, CARD_SPICES) != 0)
+    {
+      return 1;
+    }
+  }
+  else
+  {
+    return 1;
+  }
+
+  (*index)++;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Builds the alias table of a deck specification.
+/// @param sampler A pointer to the sampler to build.
+/// @param spec A pointer to the deck specification.
+/// @return 0 if the sampler was built; 1 if all weights are 0.
+int initDeckSampler(DeckSampler *sampler, const DeckSpec *spec)
+{
+  double probabilities[CARD_KINDS];
+  double total = 0.0;
+  for (int index = 0; index < CARD_KINDS; index++)
+  {
+    probabilities[index] = (double)spec->value_weights[index % CARD_VALUES] * spec->spice_weights[index / CARD_VALUES];
+    total += probabilities[index];
+  }
+  if (total <= 0.0)
+  {
+    return 1;
+  }
+
+  int small[CARD_KINDS];
+  int large[CARD_KINDS];
+  int small_count = 0;
+  int large_count = 0;
+  for (int index = 0; index < CARD_KINDS; index++)
+  {
+    probabilities[index] *= CARD_KINDS / total;
+    if (probabilities[index] < 1.0)
+      small[small_count++] = index;
+    else
+      large[large_count++] = index;
+  }
+
+  while (small_count > 0 && large_count > 0)
+  {
+    int low = small[--small_count];
+    int high = large[--large_count];
+    sampler->thresholds[low] = (uint32_t)(probabilities[low] * 4294967296.0);
+    sampler->aliases[low] = (uint8_t)high;
+
+    probabilities[high] += probabilities[low] - 1.0;
+    if (probabilities[high] < 1.0)
+      small[small_count++] = high;
+    else
+      large[large_count++] = high;
+  }
+
+  // What is left has a probability of 1 up to rounding errors and always keeps its column.
+  while (small_count > 0)
+  {
+    int index = small[--small_count];
+    sampler->thresholds[index] = UINT32_MAX;
+    sampler->aliases[index] = (uint8_t)index;
+  }
+  while (large_count > 0)
+  {
+    int index = large[--large_count];
+    sampler->thresholds[index] = UINT32_MAX;
+    sampler->aliases[index] = (uint8_t)index;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Derives the seed of one deck from the seed of a run, so that every deck can be generated independently.
+/// @param seed The seed of the run.
+/// @param deck The number of the deck, counting from 0.
+/// @return The seed of the deck.
+uint64_t deckSeed(uint64_t seed, long long deck)
+{
+  uint64_t rng = seed ^ (uint64_t)deck * 0xD1B54A32D192ED03ULL;
+  return nextRandom(&rng);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Generates a deck in dealing order.
+/// @param sampler A pointer to the sampler of the deck specification.
+/// @param size The number of cards.
+/// @param seed The seed of the deck, see deckSeed.
+/// @param kinds The array of at least size entries receiving the kind index of every card.
+void generateDeck(const DeckSampler *sampler, int size, uint64_t seed, uint8_t *kinds)
+{
+  uint64_t rng = seed;
+  for (int i = 0; i < size; i++)
+  {
+    uint64_t random = nextRandom(&rng);
+    int column = (int)(((random >> 32) * CARD_KINDS) >> 32);
+    kinds[i] = (uint32_t)random < sampler->thresholds[column] ? (uint8_t)column : sampler->aliases[column];
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Formats a deck as the content of a configuration file.
+/// @param kinds The kind index of every card.
+/// @param size The number of cards.
+/// @param text A buffer of at least 4 + 5 * size characters.
+/// @return The number of characters written.
+static size_t formatDeck(const uint8_t *kinds, int size, char *text)
+{
+  size_t length = 0;
+  memcpy(text, "ESP\n", 4);
+  length += 4;
+  for (int i = 0; i < size; i++)
+  {
+    int value = cardValue(kinds[i]);
+    if (value == CARD_VALUES)
+    {
+      text[length++] = '1';
+      text[length++] = '0';
+    }
+    else
+    {
+      text[length++] = (char)('0' + value);
+    }
+    text[length++] = '_';
+    text[length++] = cardSpice(kinds[i]);
+    text[length++] = '\n';
+  }
+  return length;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the usage of the generator mode.
+/// @return 1, the exit code for invalid arguments.
+static int generateUsage(void)
+{
+  printf("Usage: ./a4-csf --generate <cards> [--seed <seed>] [--deck <number>] [--values <w1,...,w10>] "
+         "[--spices <wc,wp,ww>] [--output <config file>]\n");
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Entry point of the generator mode started with "--generate".
+/// Generates one deck and writes it as a configuration file to stdout or to the file given with "--output".
+/// "--deck <number>" generates the deck that a simulation with the same seed and options plays in that game.
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// @return 0 if the deck was written; 1 for invalid arguments; 2 if the file cannot be written; 4 if there is not
+/// enough memory.
+int runGenerate(int argc, char *argv[])
+{
+  DeckSpec spec = DECK_DEFAULTS;
+  uint64_t seed = 1;
+  long long deck = 0;
+  const char *output_path = NULL;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+    {
+      seed = strtoull(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "--deck") == 0 && i + 1 < argc)
+    {
+      char *rest = NULL;
+      deck = strtoll(argv[++i], &rest, 10);
+      if (*rest != '\0' || deck < 0)
+      {
+        return generateUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+    {
+      output_path = argv[++i];
+    }
+    else if (parseDeckOption(argv, &i, argc, &spec) != 0)
+    {
+      return generateUsage();
+    }
+  }
+
+  DeckSampler sampler;
+  if (spec.size == 0 || initDeckSampler(&sampler, &spec) != 0)
+  {
+    return generateUsage();
+  }
+
+  uint8_t *kinds = malloc(spec.size);
+  char *text = malloc(4 + 5 * (size_t)spec.size);
+  if (!kinds || !text)
+  {
+    printf("Error: Out of memory\n");
+    free(kinds);
+    free(text);
+    return 4;
+  }
+
+  generateDeck(&sampler, spec.size, deckSeed(seed, deck), kinds);
+  size_t length = formatDeck(kinds, spec.size, text);
+  free(kinds);
+
+  FILE *file = output_path ? fopen(output_path, "wb") : stdout;
+  if (!file)
+  {
+    printf("Error: Cannot open file: %s\n", output_path);
+    free(text);
+    return 2;
+  }
+  int failed = fwrite(text, 1, length, file) != length;
+  failed |= output_path ? fclose(file) != 0 : fflush(file) != 0;
+  free(text);
+
+  if (failed)
+  {
+    printf("Error: Cannot write file: %s\n", output_path ? output_path : "stdout");
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Random deck generator of "Entertaining Spice Pretending".
+//
+// Decks of any size are drawn card by card from a distribution given by a weight per value and a weight per spice.
+// Every deck is derived from a seed and a deck number alone, so a deck of a long simulation can be generated again
+// on its own, written as an "ESP" configuration file or played directly from memory.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef DECKGEN_H
+#define DECKGEN_H
+
+#include <stdint.h>
+
+#include "engine.h"
+
+#define DECK_MAX_CARDS 1000000
+#define CARD_SPICES 3
+
+// Size and composition of generated decks. The chance of a card kind is the product of the weight of its value and
+// the weight of its spice. A size of 0 means that no deck is generated.
+typedef struct DeckSpec
+{
+  int size;
+  uint32_t value_weights[CARD_VALUES];
+  uint32_t spice_weights[CARD_SPICES];
+} DeckSpec;
+
+// Alias table drawing a card kind with one random number: a column is chosen uniformly and either kept or replaced
+// by its alias depending on its threshold.
+typedef struct DeckSampler
+{
+  uint32_t thresholds[CARD_KINDS];
+  uint8_t aliases[CARD_KINDS];
+} DeckSampler;
+
+extern const DeckSpec DECK_DEFAULTS;
+
+int parseDeckOption(char *argv[], int *index, int end, DeckSpec *spec);
+int initDeckSampler(DeckSampler *sampler, const DeckSpec *spec);
+uint64_t deckSeed(uint64_t seed, long long deck);
+void generateDeck(const DeckSampler *sampler, int size, uint64_t seed, uint8_t *kinds);
+int runGenerate(int argc, char *argv[]);
+
+#endif
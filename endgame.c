@@ -0,0 +1,535 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Endgame solver of "Entertaining Spice Pretending".
+//
+// The rules never look at a card except to compare a claim with the real card, so a position is described by a few
+// public counters, the sizes of both hands and of the draw pile, the cards played this round, the player to move and
+// whether each player has a face-down card on the table, and by the lie bits of those cards, which only their owner
+// knows. For every public position the solver computes the value for the player to move under every combination of
+// lie bits, searching the positions depth first and storing them in a transposition table under their Zobrist key.
+//
+// At every position the player to move picks, for each state of their own card, the move with the best expected
+// value over their belief about the opponent's card. The player's belief about the opponent's card at the root comes
+// from the cards the player has not seen; any other card is believed to be the claimed card CLAIM_BELIEF percent of
+// the time and a lie about value and spice otherwise. Since these beliefs are fixed instead of following from how the
+// opponent plays inside the search, the values are estimates, not the value of optimal play.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "endgame.h"
+
+#define MOVE_DRAW 0
+#define MOVE_CHALLENGE_VALUE 1
+#define MOVE_CHALLENGE_SPICE 2
+// A play is MOVE_PLAY plus the lie bits of its claim.
+#define MOVE_PLAY 3
+#define MOVE_COUNT 7
+
+#define LIE_VALUE 1
+#define LIE_SPICE 2
+#define LIE_BOTH (LIE_VALUE | LIE_SPICE)
+#define LIE_STATES 4
+
+// Percentage of the time a face-down card is believed to be the claimed card, as in ismcts.c.
+#define CLAIM_BELIEF 70
+
+// Every counter of a position stays below this limit, which bounds the Zobrist tables.
+#define COUNTER_LIMIT 256
+
+// An entry holds the values of a position for all states of both face-down cards, so the table has fewer entries than
+// a table of single values; searches rarely solve more than a few thousand positions.
+#define TABLE_BITS 13
+#define TABLE_SIZE (1 << TABLE_BITS)
+
+// Values of a position for the player to move by the lie bits of that player's face-down card and of the opponent's
+// face-down card, where 0 also stands for no card.
+typedef double Values[LIE_STATES][LIE_STATES];
+
+typedef struct Position
+{
+  int hand[2];
+  int pile;
+  int cards_played;
+  int seat;
+  int face_down[2];
+  int root_card[2];
+  uint64_t key;
+} Position;
+
+typedef struct TableEntry
+{
+  uint64_t key;
+  Values values;
+} TableEntry;
+
+typedef struct Solver
+{
+  uint64_t hand_keys[2][COUNTER_LIMIT];
+  uint64_t pile_keys[COUNTER_LIMIT];
+  uint64_t played_keys[COUNTER_LIMIT];
+  uint64_t face_down_keys[2][2];
+  uint64_t root_card_keys[2][2];
+  uint64_t seat_key;
+  int first_seat;
+  double root_belief[LIE_STATES];
+  long long positions;
+  TableEntry table[TABLE_SIZE];
+} Solver;
+
+static void solvePosition(Solver *solver, const Position *position, Values values);
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Fills the Zobrist tables of a solver with fixed pseudo random numbers and empties its transposition table.
+/// @param solver A pointer to the solver.
+static void initSolver(Solver *solver)
+{
+  uint64_t rng = 0x5EED5EED5EED5EEDULL;
+  for (int value = 0; value < COUNTER_LIMIT; value++)
+  {
+    solver->hand_keys[0][value] = nextRandom(&rng);
+    solver->hand_keys[1][value] = nextRandom(&rng);
+    solver->pile_keys[value] = nextRandom(&rng);
+    solver->played_keys[value] = nextRandom(&rng);
+  }
+  for (int seat = 0; seat < 2; seat++)
+  {
+    for (int flag = 0; flag < 2; flag++)
+    {
+      solver->face_down_keys[seat][flag] = nextRandom(&rng);
+      solver->root_card_keys[seat][flag] = nextRandom(&rng);
+    }
+  }
+  solver->seat_key = nextRandom(&rng);
+  solver->positions = 0;
+  memset(solver->table, 0, sizeof(solver->table));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Computes the Zobrist key of a position from scratch.
+/// @param solver A pointer to the solver.
+/// @param position A pointer to the position, whose key is set.
+static void hashPosition(const Solver *solver, Position *position)
+{
+  position->key = solver->hand_keys[0][position->hand[0]] ^ solver->hand_keys[1][position->hand[1]] ^
+                  solver->pile_keys[position->pile] ^ solver->played_keys[position->cards_played] ^
+                  (position->seat ? solver->seat_key : 0);
+  for (int seat = 0; seat < 2; seat++)
+  {
+    position->key ^= solver->face_down_keys[seat][position->face_down[seat]] ^
+                     solver->root_card_keys[seat][position->root_card[seat]];
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Changes a counter of a position and updates the key of the position.
+/// @param key A pointer to the key of the position.
+/// @param keys The Zobrist table of the counter.
+/// @param counter A pointer to the counter.
+/// @param value The new value of the counter.
+static inline void setCounter(uint64_t *key, const uint64_t *keys, int *counter, int value)
+{
+  *key ^= keys[*counter] ^ keys[value];
+  *counter = value;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Hands the turn to the other player and solves the resulting position.
+/// @param solver A pointer to the solver.
+/// @param child A pointer to the position after the move, still with the seat of the player who moved.
+/// @param values The values of the position for the other player.
+static void passTurn(Solver *solver, Position *child, Values values)
+{
+  child->seat = 1 - child->seat;
+  child->key ^= solver->seat_key;
+  solvePosition(solver, child, values);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Computes the value of a challenge for the challenger once its outcome is known. Both face-down cards are turned
+/// over, so the following position has no hidden card.
+/// @param solver A pointer to the solver.
+/// @param position A pointer to the position before the challenge.
+/// @param successful 1 if the challenged claim is a lie in the challenged property; 0 otherwise.
+/// @return The points the challenger scores from now on minus the points of the opponent.
+static double challengeValue(Solver *solver, const Position *position, int successful)
+{
+  int seat = position->seat;
+  int other = 1 - seat;
+  int receiver = successful ? other : seat;
+  Position child = *position;
+  int taken = child.pile < STANDARD_PENALTY_CARDS ? child.pile : STANDARD_PENALTY_CARDS;
+
+  setCounter(&child.key, solver->hand_keys[receiver], &child.hand[receiver], child.hand[receiver] + taken);
+  setCounter(&child.key, solver->pile_keys, &child.pile, child.pile - taken);
+  double points = successful ? position->cards_played + (child.hand[other] == 0 ? STANDARD_EMPTY_HAND_BONUS : 0)
+                             : -position->cards_played;
+
+  setCounter(&child.key, solver->played_keys, &child.cards_played, 0);
+  for (int player = 0; player < 2; player++)
+  {
+    setCounter(&child.key, solver->face_down_keys[player], &child.face_down[player], 0);
+    setCounter(&child.key, solver->root_card_keys[player], &child.root_card[player], 0);
+  }
+  if (child.pile == 0)
+  {
+    return points;
+  }
+
+  Values values;
+  passTurn(solver, &child, values);
+  return points - values[0][0];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Computes the values of a move for the player to move: the points that player scores from now on minus the points
+/// of the opponent, for every state of both face-down cards.
+/// @param solver A pointer to the solver.
+/// @param position A pointer to the position.
+/// @param move The move, which has to be legal.
+/// @param values The values of the move, indexed like the values of the position.
+static void moveValues(Solver *solver, const Position *position, int move, Values values)
+{
+  int seat = position->seat;
+  Position child = *position;
+  Values child_values;
+  memset(values, 0, sizeof(Values));
+
+  if (move == MOVE_CHALLENGE_VALUE || move == MOVE_CHALLENGE_SPICE)
+  {
+    int tested = move == MOVE_CHALLENGE_VALUE ? LIE_VALUE : LIE_SPICE;
+    double outcomes[2] = {challengeValue(solver, position, 0), challengeValue(solver, position, 1)};
+    for (int own = 0; own < LIE_STATES; own++)
+    {
+      for (int other = 0; other < LIE_STATES; other++)
+      {
+        values[own][other] = outcomes[(other & tested) != 0];
+      }
+    }
+    return;
+  }
+
+  if (move == MOVE_DRAW)
+  {
+    if (child.pile == 0)
+    {
+      return;
+    }
+    setCounter(&child.key, solver->hand_keys[seat], &child.hand[seat], child.hand[seat] + 1);
+    setCounter(&child.key, solver->pile_keys, &child.pile, child.pile - 1);
+    if (child.pile == 0)
+    {
+      return;
+    }
+  }
+  else
+  {
+    setCounter(&child.key, solver->hand_keys[seat], &child.hand[seat], child.hand[seat] - 1);
+    setCounter(&child.key, solver->played_keys, &child.cards_played, child.cards_played + 1);
+    setCounter(&child.key, solver->face_down_keys[seat], &child.face_down[seat], 1);
+    setCounter(&child.key, solver->root_card_keys[seat], &child.root_card[seat], 0);
+  }
+
+  passTurn(solver, &child, child_values);
+  for (int own = 0; own < LIE_STATES; own++)
+  {
+    int played = move == MOVE_DRAW ? own : move - MOVE_PLAY;
+    for (int other = 0; other < LIE_STATES; other++)
+    {
+      values[own][other] = -child_values[other][played];
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Lists the moves of the player to move.
+/// @param position A pointer to the position.
+/// @param moves An array of at least MOVE_COUNT entries receiving the moves.
+/// @return The number of moves.
+static int positionMoves(const Position *position, int *moves)
+{
+  int count = 0;
+  if (position->hand[position->seat] > 0)
+  {
+    for (int lie = 0; lie < LIE_STATES; lie++)
+    {
+      moves[count++] = MOVE_PLAY + lie;
+    }
+  }
+  if (position->face_down[1 - position->seat])
+  {
+    moves[count++] = MOVE_CHALLENGE_VALUE;
+    moves[count++] = MOVE_CHALLENGE_SPICE;
+  }
+  moves[count++] = MOVE_DRAW;
+  return count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the belief of the player to move about the lie bits of the opponent's face-down card.
+/// @param solver A pointer to the solver.
+/// @param position A pointer to the position.
+/// @param belief An array of LIE_STATES probabilities receiving the belief.
+static void positionBelief(const Solver *solver, const Position *position, double *belief)
+{
+  int other = 1 - position->seat;
+  memset(belief, 0, sizeof(double) * LIE_STATES);
+  if (!position->face_down[other])
+  {
+    belief[0] = 1.0;
+  }
+  else if (position->seat == 0 && position->root_card[other])
+  {
+    memcpy(belief, solver->root_belief, sizeof(double) * LIE_STATES);
+  }
+  else
+  {
+    belief[0] = CLAIM_BELIEF / 100.0;
+    belief[LIE_BOTH] = 1.0 - belief[0];
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Computes the value a row of values is expected to have under a belief about the opponent's face-down card.
+/// @param values The values by the lie bits of the opponent's card.
+/// @param belief The probabilities of the lie bits of the opponent's card.
+/// @return The expected value.
+static double expectedValue(const double *values, const double *belief)
+{
+  double expected = 0.0;
+  for (int other = 0; other < LIE_STATES; other++)
+  {
+    expected += belief[other] * values[other];
+  }
+  return expected;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Finds the move with the best expected value for the player to move, who knows their own face-down card.
+/// @param move_values The values of the moves.
+/// @param move_count The number of moves.
+/// @param own The lie bits of the face-down card of the player to move.
+/// @param belief The belief of the player about the opponent's face-down card.
+/// @return The index of the best move.
+static int bestMove(Values *move_values, int move_count, int own, const double *belief)
+{
+  int best = 0;
+  double best_value = expectedValue(move_values[0][own], belief);
+  for (int i = 1; i < move_count; i++)
+  {
+    double value = expectedValue(move_values[i][own], belief);
+    if (value > best_value)
+    {
+      best = i;
+      best_value = value;
+    }
+  }
+  return best;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Computes the values of a position for the player to move, looking it up in the transposition table first. For
+/// every state of their own face-down card, the player plays the move that is best under their belief about the
+/// opponent's card. The search always ends because every move either takes a card from the draw pile or plays a
+/// hand card. Running out of cards ends the game only before the turn of player 1, whose seat in the search is
+/// first_seat.
+/// @param solver A pointer to the solver.
+/// @param position A pointer to the position.
+/// @param values The values receiving the points the player to move scores from now on minus the points of the
+/// opponent.
+static void solvePosition(Solver *solver, const Position *position, Values values)
+{
+  if (position->seat == solver->first_seat && position->pile == 0 && position->hand[0] == 0 && position->hand[1] == 0)
+  {
+    memset(values, 0, sizeof(Values));
+    return;
+  }
+
+  // Key 0 marks an empty entry, so the lowest bit is always set in stored keys.
+  uint64_t check = position->key | 1;
+  TableEntry *entry = &solver->table[position->key >> (64 - TABLE_BITS)];
+  if (entry->key == check)
+  {
+    memcpy(values, entry->values, sizeof(Values));
+    return;
+  }
+  solver->positions++;
+
+  int moves[MOVE_COUNT];
+  Values move_values[MOVE_COUNT];
+  int move_count = positionMoves(position, moves);
+  for (int i = 0; i < move_count; i++)
+  {
+    moveValues(solver, position, moves[i], move_values[i]);
+  }
+
+  double belief[LIE_STATES];
+  positionBelief(solver, position, belief);
+  for (int own = 0; own < LIE_STATES; own++)
+  {
+    int best = bestMove(move_values, move_count, own, belief);
+    memcpy(values[own], move_values[best][own], sizeof(values[own]));
+  }
+
+  entry->key = check;
+  memcpy(entry->values, values, sizeof(Values));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the lie bits of the claim of a played card.
+/// @param player A pointer to the player.
+/// @return 0 if the player has no face-down card or told the truth; the lie bits of its claim otherwise.
+static int claimLie(const Player *player)
+{
+  if (!player->has_played)
+  {
+    return 0;
+  }
+  return (player->claimed_card.value != player->latest_card.value ? LIE_VALUE : 0) +
+         (player->claimed_card.spice != player->latest_card.spice ? LIE_SPICE : 0);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Estimates how likely the opponent's face-down card lies about its value or spice. The card is the claimed card
+/// CLAIM_BELIEF percent of the time if that card can still be hidden, and otherwise any card the player has not
+/// seen.
+/// @param view The state of the game visible to the player; the opponent has to have a face-down card.
+/// @param belief An array of LIE_STATES probabilities of the lie bits of the card receiving the estimate.
+static void faceDownBelief(const TurnView *view, double *belief)
+{
+  const uint32_t *pool = view->tracker->unseen;
+  uint32_t pool_size = view->tracker->total;
+
+  memset(belief, 0, sizeof(double) * LIE_STATES);
+  if (pool_size == 0)
+  {
+    belief[0] = 1.0;
+    return;
+  }
+
+  const Card *claim = &view->opponent->claimed_card;
+  int claimed = cardIndex(claim->value, claim->spice);
+  double trust = claimed >= 0 && pool[claimed] > 0 ? CLAIM_BELIEF / 100.0 : 0.0;
+  for (int index = 0; index < CARD_KINDS; index++)
+  {
+    if (pool[index] == 0)
+    {
+      continue;
+    }
+    int lie = (cardValue(index) != claim->value ? LIE_VALUE : 0) + (cardSpice(index) != claim->spice ? LIE_SPICE : 0);
+    belief[lie] += (1.0 - trust) * pool[index] / pool_size + (index == claimed ? trust : 0.0);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Turns a move of the solver into an action. Plays use the lowest hand card.
+/// @param move The move.
+/// @param hand A pointer to the hand of the player to move.
+/// @param action A pointer to the action to fill in.
+static void moveAction(int move, const Hand *hand, Action *action)
+{
+  if (move == MOVE_DRAW)
+  {
+    action->type = ACTION_DRAW;
+  }
+  else if (move == MOVE_CHALLENGE_VALUE || move == MOVE_CHALLENGE_SPICE)
+  {
+    action->type = ACTION_CHALLENGE;
+    action->challenge_value = move == MOVE_CHALLENGE_VALUE;
+  }
+  else
+  {
+    int index = handFirst(hand);
+    int lie = move - MOVE_PLAY;
+    action->type = ACTION_PLAY;
+    action->hand_value = cardValue(index);
+    action->hand_spice = cardSpice(index);
+    action->claimed_value = lie & LIE_VALUE ? cardValue(index) % CARD_VALUES + 1 : cardValue(index);
+    action->claimed_spice = lie & LIE_SPICE ? cardSpice((index + CARD_VALUES) % CARD_KINDS) : cardSpice(index);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Solves the endgame of the player to move and finds the move with the best estimated score margin under the
+/// player's belief about the opponent's face-down card.
+/// @param view The state of the game visible to the player. view->tracker is needed to estimate the opponent's
+/// face-down card.
+/// @param advice A pointer to the structure receiving the move, the estimated final score of the player minus the
+/// final score of the opponent, and the number of positions solved.
+/// @return 0 if the endgame was solved; 1 if more than ENDGAME_UNSEEN cards are unseen, the position cannot be
+/// estimated or there is not enough memory.
+int solveEndgame(const TurnView *view, EndgameAdvice *advice)
+{
+  Position root;
+  root.hand[0] = view->self->hand.size;
+  root.hand[1] = view->opponent->hand.size;
+  root.pile = pileCount(view->draw_pile);
+  root.cards_played = view->cards_played_this_round;
+  root.seat = 0;
+  root.face_down[0] = root.root_card[0] = view->self->has_played;
+  root.face_down[1] = root.root_card[1] = view->opponent->has_played;
+
+  if (root.hand[1] + root.pile > ENDGAME_UNSEEN || root.cards_played < 0 ||
+      root.cards_played + root.hand[0] + root.hand[1] + root.pile >= COUNTER_LIMIT ||
+      (view->opponent->has_played && !view->tracker))
+  {
+    return 1;
+  }
+
+  Solver *solver = malloc(sizeof(Solver));
+  if (!solver)
+  {
+    return 1;
+  }
+  initSolver(solver);
+  solver->first_seat = view->seat;
+  if (view->opponent->has_played)
+  {
+    faceDownBelief(view, solver->root_belief);
+  }
+  hashPosition(solver, &root);
+
+  int moves[MOVE_COUNT];
+  Values move_values[MOVE_COUNT];
+  int move_count = positionMoves(&root, moves);
+  for (int i = 0; i < move_count; i++)
+  {
+    moveValues(solver, &root, moves[i], move_values[i]);
+  }
+
+  double belief[LIE_STATES];
+  positionBelief(solver, &root, belief);
+  int own = claimLie(view->self);
+  int best = bestMove(move_values, move_count, own, belief);
+
+  moveAction(moves[best], &view->self->hand, &advice->action);
+  advice->margin = view->self->score - view->opponent->score + expectedValue(move_values[best][own], belief);
+  advice->positions = solver->positions;
+  free(solver);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Strategy playing the move of the endgame solver once the endgame is reached, and before that its lowest hand
+/// card truthfully like the honest strategy.
+/// @param view The state of the game visible to the player.
+/// @param action A pointer to the action to fill in.
+/// @param context Unused.
+void strategyEndgame(const TurnView *view, Action *action, void *context)
+{
+  (void)context;
+  EndgameAdvice advice;
+  if (solveEndgame(view, &advice) == 0)
+  {
+    *action = advice.action;
+  }
+  else
+  {
+    moveAction(handIsEmpty(&view->self->hand) ? MOVE_DRAW : MOVE_PLAY, &view->self->hand, action);
+  }
+}
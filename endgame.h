@@ -0,0 +1,33 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Endgame solver of "Entertaining Spice Pretending".
+//
+// Once few cards are unseen, the solver picks a move by exhaustive search of the rest of the game. Face-down cards
+// stay hidden inside the search: wherever a player moves, the moves are weighed by that player's belief about the
+// opponent's face-down card, which for the opponent's card at the root is estimated by counting the cards the player
+// has not seen. The beliefs are fixed, so the margins are estimates, not the value of optimal play.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include "simulate.h"
+
+// Largest number of cards in the opponent's hand and the draw pile together for which the solver gives advice.
+#define ENDGAME_UNSEEN 12
+
+typedef struct EndgameAdvice
+{
+  Action action;
+  double margin;
+  long long positions;
+} EndgameAdvice;
+
+int solveEndgame(const TurnView *view, EndgameAdvice *advice);
+void strategyEndgame(const TurnView *view, Action *action, void *context);
+
+#endif
@@ -0,0 +1,215 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Rule functions of "Entertaining Spice Pretending" that are shared by the interactive game and the headless
+// simulation. Nothing in here reads input or prints narration, so the functions can be called in a tight loop.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include "engine.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Distributes cards from the deck to two players and a draw pile.
+/// Each player is initially dealt hand_size cards, alternating between players, and the remaining cards become the
+/// draw pile in deck order. Inlined into both callers, so that the standard rules deal with a constant hand size.
+/// @param deck The kind indices of the cards in dealing order. The draw pile keeps pointing into it.
+/// @param deck_size The number of cards in the deck.
+/// @param player1 The first player to receive cards.
+/// @param player2 The second player to receive cards.
+/// @param draw_pile A pointer to the draw pile receiving the remaining cards.
+/// @param hand_size The number of cards dealt to each player.
+static inline void dealCards(const uint8_t *deck, int deck_size, Player *player1, Player *player2,
+                             DrawPile *draw_pile, int hand_size)
+{
+  int dealt = deck_size < 2 * hand_size ? deck_size : 2 * hand_size;
+  for (int i = 0; i < dealt; i++)
+  {
+    handAdd(i & 1 ? &player2->hand : &player1->hand, deck[i]);
+  }
+
+  draw_pile->kinds = deck;
+  draw_pile->top = dealt;
+  draw_pile->size = deck_size;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Distributes cards from the deck to two players and a draw pile with the standard rules, dealing 6 cards to each
+/// player. See dealCards.
+/// @param deck The kind indices of the cards in dealing order. The draw pile keeps pointing into it.
+/// @param deck_size The number of cards in the deck.
+/// @param player1 The first player to receive cards.
+/// @param player2 The second player to receive cards.
+/// @param draw_pile A pointer to the draw pile receiving the remaining cards.
+void distributeCards(const uint8_t *deck, int deck_size, Player *player1, Player *player2, DrawPile *draw_pile)
+{
+  dealCards(deck, deck_size, player1, player2, draw_pile, STANDARD_HAND_SIZE);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Distributes cards from the deck to two players and a draw pile with the hand size of a variant of the rules.
+/// @param deck The kind indices of the cards in dealing order. The draw pile keeps pointing into it.
+/// @param deck_size The number of cards in the deck.
+/// @param player1 The first player to receive cards.
+/// @param player2 The second player to receive cards.
+/// @param draw_pile A pointer to the draw pile receiving the remaining cards.
+/// @param rules A pointer to the rules of the game.
+void distributeVariantCards(const uint8_t *deck, int deck_size, Player *player1, Player *player2, DrawPile *draw_pile,
+                            const Rules *rules)
+{
+  dealCards(deck, deck_size, player1, player2, draw_pile, rules->hand_size);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Resets the round by forgetting the latest and claimed cards of both players and resetting the cards played count.
+/// @param player1 A pointer to the first player's data structure.
+/// @param player2 A pointer to the second player's data structure.
+/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
+void resetRound(Player *player1, Player *player2, int *cards_played_this_round)
+{
+  player1->has_played = 0;
+  player2->has_played = 0;
+  *cards_played_this_round = 0;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays a card from the player's hand face-down while claiming it to be another card.
+/// Removes the real card from the hand and stores it together with the claimed card in the player.
+/// @param current_player A pointer to the player playing the card.
+/// @param hand_value The value of the card to take from the hand.
+/// @param hand_spice The spice of the card to take from the hand.
+/// @param claimed_value The value the player claims the card to have.
+/// @param claimed_spice The spice the player claims the card to have.
+/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
+/// @param latest_card_number A pointer to the variable storing the claimed value of the latest card played.
+/// @param latest_card_spice A pointer to the variable storing the claimed spice of the latest card played.
+/// @return 0 if the card was played;
+/// 1 if the card is not in the player's hand.
+int playCard(Player *current_player, int hand_value, char hand_spice, int claimed_value, char claimed_spice,
+             int *cards_played_this_round, int *latest_card_number, int *latest_card_spice)
+{
+  int index = cardIndex(hand_value, hand_spice);
+  if (!handHolds(&current_player->hand, index))
+  {
+    return 1;
+  }
+
+  handRemove(&current_player->hand, index);
+  current_player->has_played = 1;
+  current_player->latest_card.value = hand_value;
+  current_player->latest_card.spice = hand_spice;
+  current_player->claimed_card.value = claimed_value;
+  current_player->claimed_card.spice = claimed_spice;
+
+  *latest_card_number = claimed_value;
+  *latest_card_spice = claimed_spice;
+  (*cards_played_this_round)++;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Moves up to the given number of cards from the top of the draw pile into the player's hand. The pile itself
+/// only advances its top index once.
+/// @param player A pointer to the player receiving the cards.
+/// @param draw_pile A pointer to the draw pile.
+/// @param count The maximum number of cards to move.
+void takeCards(Player *player, DrawPile *draw_pile, int count)
+{
+  int end = pileCount(draw_pile) < count ? draw_pile->size : draw_pile->top + count;
+  for (int i = draw_pile->top; i < end; i++)
+  {
+    handAdd(&player->hand, draw_pile->kinds[i]);
+  }
+  draw_pile->top = end;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Resolves a challenge against the opponent's latest claimed card and updates scores, hands and the draw pile.
+/// Inlined into both callers, so that the standard rules settle a challenge with constant card counts and bonus.
+/// @param challenger A pointer to the player issuing the challenge.
+/// @param opponent A pointer to the player whose claimed card is being challenged.
+/// @param challenge_value 1 to challenge the value of the claimed card, 0 to challenge its spice.
+/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
+/// @param draw_pile A pointer to the draw pile where cards are stored.
+/// @param penalty_cards The number of cards the loser of the challenge takes from the draw pile.
+/// @param empty_hand_bonus The points for a successful challenge that leaves the opponent without cards.
+/// @param result A pointer to the structure receiving the outcome, used by the caller for narration.
+static inline void settleChallenge(Player *challenger, Player *opponent, int challenge_value,
+                                   int *cards_played_this_round, DrawPile *draw_pile, int penalty_cards,
+                                   int empty_hand_bonus, ChallengeResult *result)
+{
+  if (challenge_value)
+    result->successful = opponent->claimed_card.value != opponent->latest_card.value;
+  else
+    result->successful = opponent->claimed_card.spice != opponent->latest_card.spice;
+
+  result->points = *cards_played_this_round;
+  result->real_value = opponent->latest_card.value;
+  result->real_spice = opponent->latest_card.spice;
+  result->bonus = 0;
+
+  if (result->successful)
+  {
+    challenger->score += *cards_played_this_round;
+    takeCards(opponent, draw_pile, penalty_cards);
+
+    if (handIsEmpty(&opponent->hand))
+    {
+      challenger->score += empty_hand_bonus;
+      result->bonus = empty_hand_bonus;
+    }
+  }
+  else
+  {
+    opponent->score += *cards_played_this_round;
+    takeCards(challenger, draw_pile, penalty_cards);
+  }
+
+  resetRound(challenger, opponent, cards_played_this_round);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Resolves a challenge against the opponent's latest claimed card with the standard rules: the loser takes 2 cards
+/// and emptying the opponent's hand is worth 10 points. See settleChallenge.
+/// The caller has to make sure that the opponent has played a card this round.
+/// @param challenger A pointer to the player issuing the challenge.
+/// @param opponent A pointer to the player whose claimed card is being challenged.
+/// @param challenge_value 1 to challenge the value of the claimed card, 0 to challenge its spice.
+/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
+/// @param draw_pile A pointer to the draw pile where cards are stored.
+/// @param result A pointer to the structure receiving the outcome, used by the caller for narration.
+void resolveChallenge(Player *challenger, Player *opponent, int challenge_value, int *cards_played_this_round,
+                      DrawPile *draw_pile, ChallengeResult *result)
+{
+  settleChallenge(challenger, opponent, challenge_value, cards_played_this_round, draw_pile, STANDARD_PENALTY_CARDS,
+                  STANDARD_EMPTY_HAND_BONUS, result);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Resolves a challenge against the opponent's latest claimed card with a variant of the rules.
+/// The caller has to make sure that the opponent has played a card this round.
+/// @param challenger A pointer to the player issuing the challenge.
+/// @param opponent A pointer to the player whose claimed card is being challenged.
+/// @param challenge_value 1 to challenge the value of the claimed card, 0 to challenge its spice.
+/// @param cards_played_this_round A pointer to the counter tracking the number of cards played in the current round.
+/// @param draw_pile A pointer to the draw pile where cards are stored.
+/// @param rules A pointer to the rules of the game.
+/// @param result A pointer to the structure receiving the outcome, used by the caller for narration.
+void resolveVariantChallenge(Player *challenger, Player *opponent, int challenge_value, int *cards_played_this_round,
+                             DrawPile *draw_pile, const Rules *rules, ChallengeResult *result)
+{
+  settleChallenge(challenger, opponent, challenge_value, cards_played_this_round, draw_pile, rules->penalty_cards,
+                  rules->empty_hand_bonus, result);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Moves the top card of the draw pile into the player's hand.
+/// @param current_player A pointer to the player drawing the card.
+/// @param draw_pile A pointer to the draw pile, which must not be empty.
+void drawCard(Player *current_player, DrawPile *draw_pile)
+{
+  takeCards(current_player, draw_pile, 1);
+}
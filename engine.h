@@ -0,0 +1,234 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Core data types and rule functions of "Entertaining Spice Pretending".
+//
+// The functions declared here mutate the game state only and never read from stdin or write narration to stdout,
+// so they can be shared by the interactive terminal game (a4.c) and the headless simulation (simulate.c).
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+
+#define CARD_VALUES 10
+#define CARD_KINDS 30
+
+// The standard rules, which distributeCards and resolveChallenge play with these constants built in.
+#define STANDARD_HAND_SIZE 6
+#define STANDARD_PENALTY_CARDS 2
+#define STANDARD_EMPTY_HAND_BONUS 10
+
+typedef struct Card
+{
+  int value;
+  char spice;
+} Card;
+
+// A hand stores how many cards of each of the 30 card kinds a player holds. Kind i is the card with spice
+// "cpw"[i / 10] and value i % 10 + 1, so iterating the kinds in index order visits the cards sorted by spice and value.
+// The bits of present mark the kinds with a count greater than 0.
+typedef struct Hand
+{
+  uint32_t present;
+  uint16_t size;
+  uint16_t counts[CARD_KINDS];
+} Hand;
+
+typedef struct Player
+{
+  Hand hand;
+  int score;
+  int has_played;
+  Card latest_card;
+  Card claimed_card;
+} Player;
+
+// The draw pile is a window of the deck array: the kind indices from top to size are the cards still to be drawn,
+// with the top card at kinds[top]. Drawing or taking cards only advances top, and the array is never written, so
+// every copy of a pile shares the cards and a player can look at any card without walking or copying the pile.
+typedef struct DrawPile
+{
+  const uint8_t *kinds;
+  int top;
+  int size;
+} DrawPile;
+
+// A variant of the rules: the cards dealt to each player, the cards the loser of a challenge takes from the draw
+// pile, and the points for winning a challenge that leaves the opponent without cards. The card space of 10 values
+// and 3 spices is fixed, since a hand is a set of CARD_KINDS bits.
+typedef struct Rules
+{
+  int hand_size;
+  int penalty_cards;
+  int empty_hand_bonus;
+} Rules;
+
+typedef struct ChallengeResult
+{
+  int successful;
+  int points;
+  int bonus;
+  int real_value;
+  char real_spice;
+} ChallengeResult;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a variant of the rules is the standard rules, which can then take the faster path.
+/// @param rules A pointer to the rules.
+/// @return 1 if all rules have their standard value; 0 otherwise.
+static inline int isStandardRules(const Rules *rules)
+{
+  return rules->hand_size == STANDARD_HAND_SIZE && rules->penalty_cards == STANDARD_PENALTY_CARDS &&
+         rules->empty_hand_bonus == STANDARD_EMPTY_HAND_BONUS;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the kind index of a card.
+/// @param value The value of the card.
+/// @param spice The spice of the card.
+/// @return The index in the range [0, CARD_KINDS), or -1 if the card does not exist.
+static inline int cardIndex(int value, char spice)
+{
+  if (value < 1 || value > CARD_VALUES)
+    return -1;
+  switch (spice)
+  {
+    case 'c':
+      return value - 1;
+    case 'p':
+      return CARD_VALUES + value - 1;
+    case 'w':
+      return 2 * CARD_VALUES + value - 1;
+    default:
+      return -1;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the value of a card kind.
+/// @param index The kind index of the card.
+/// @return The value from 1 to 10.
+static inline int cardValue(int index)
+{
+  return index % CARD_VALUES + 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the spice of a card kind.
+/// @param index The kind index of the card.
+/// @return The spice 'c', 'p' or 'w'.
+static inline char cardSpice(int index)
+{
+  return "cpw"[index / CARD_VALUES];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether the draw pile has no cards left.
+/// @param pile A pointer to the draw pile.
+/// @return 1 if the pile is empty; 0 otherwise.
+static inline int pileIsEmpty(const DrawPile *pile)
+{
+  return pile->top >= pile->size;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the number of cards left in the draw pile.
+/// @param pile A pointer to the draw pile.
+/// @return The number of cards.
+static inline int pileCount(const DrawPile *pile)
+{
+  return pile->size - pile->top;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Looks at a card of the draw pile without drawing it.
+/// @param pile A pointer to the draw pile.
+/// @param depth The position of the card below the top, 0 for the top card.
+/// @return The kind index of the card, or -1 if the pile has no card at that depth.
+static inline int pilePeek(const DrawPile *pile, int depth)
+{
+  return depth >= 0 && depth < pileCount(pile) ? pile->kinds[pile->top + depth] : -1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a hand holds no cards.
+/// @param hand A pointer to the hand.
+/// @return 1 if the hand is empty; 0 otherwise.
+static inline int handIsEmpty(const Hand *hand)
+{
+  return hand->present == 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a hand holds at least one card of the given kind.
+/// @param hand A pointer to the hand.
+/// @param index The kind index of the card, or -1 for a card that does not exist.
+/// @return 1 if the card is in the hand; 0 otherwise.
+static inline int handHolds(const Hand *hand, int index)
+{
+  return index >= 0 && (hand->present >> index & 1u);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the lowest card kind in a hand, which is the first card in sorted order.
+/// @param hand A pointer to the hand.
+/// @return The kind index of the card, or -1 if the hand is empty.
+static inline int handFirst(const Hand *hand)
+{
+  return hand->present ? __builtin_ctz(hand->present) : -1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the next card kind in a hand after the given one. Together with handFirst this iterates the distinct
+/// cards of a hand in sorted order without ever sorting, skipping the kinds the hand does not hold.
+/// @param hand A pointer to the hand.
+/// @param index The kind index of the current card.
+/// @return The kind index of the next card, or -1 if there is none.
+static inline int handNext(const Hand *hand, int index)
+{
+  uint32_t rest = index + 1 < CARD_KINDS ? hand->present >> (index + 1) << (index + 1) : 0;
+  return rest ? __builtin_ctz(rest) : -1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds a card to a hand.
+/// @param hand A pointer to the hand.
+/// @param index The kind index of the card.
+static inline void handAdd(Hand *hand, int index)
+{
+  hand->counts[index]++;
+  hand->present |= 1u << index;
+  hand->size++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Removes a card from a hand. The card has to be in the hand.
+/// @param hand A pointer to the hand.
+/// @param index The kind index of the card.
+static inline void handRemove(Hand *hand, int index)
+{
+  if (--hand->counts[index] == 0)
+    hand->present &= ~(1u << index);
+  hand->size--;
+}
+
+void distributeCards(const uint8_t *deck, int deck_size, Player *player1, Player *player2, DrawPile *draw_pile);
+void distributeVariantCards(const uint8_t *deck, int deck_size, Player *player1, Player *player2, DrawPile *draw_pile,
+                            const Rules *rules);
+void resetRound(Player *player1, Player *player2, int *cards_played_this_round);
+
+int playCard(Player *current_player, int hand_value, char hand_spice, int claimed_value, char claimed_spice,
+             int *cards_played_this_round, int *latest_card_number, int *latest_card_spice);
+void resolveChallenge(Player *challenger, Player *opponent, int challenge_value, int *cards_played_this_round,
+                      DrawPile *draw_pile, ChallengeResult *result);
+void resolveVariantChallenge(Player *challenger, Player *opponent, int challenge_value, int *cards_played_this_round,
+                             DrawPile *draw_pile, const Rules *rules, ChallengeResult *result);
+void takeCards(Player *player, DrawPile *draw_pile, int count);
+void drawCard(Player *current_player, DrawPile *draw_pile);
+
+#endif
@@ -0,0 +1,155 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Embeddable engine of "Entertaining Spice Pretending".
+//
+// A game of the library is a turn machine with its own copy of the deck, which the draw pile points into, and the
+// events of the latest step. Actions are checked before they are stepped, so the turn machine of a library game
+// always waits for a complete command and never for the cards of an announced play.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "espgame.h"
+
+struct EspGame
+{
+  TurnMachine machine;
+  TurnEvents events;
+  uint8_t deck[];
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Creates a game and deals its deck with the standard rules. The events of the game are then the start of the
+/// first round and the turn of player 1, or the end of the game if the deck has no cards.
+/// @param deck The kind indices of the cards in dealing order, see cardIndex. The game keeps its own copy.
+/// @param deck_size The number of cards in the deck.
+/// @return The game, to be released with espFreeGame, or NULL if a kind index is invalid or there is not enough
+/// memory.
+EspGame *espCreateGame(const uint8_t *deck, int deck_size)
+{
+  if (deck_size < 0)
+  {
+    return NULL;
+  }
+  for (int i = 0; i < deck_size; i++)
+  {
+    if (deck[i] >= CARD_KINDS)
+    {
+      return NULL;
+    }
+  }
+
+  EspGame *game = malloc(sizeof(EspGame) + (size_t)deck_size);
+  if (!game)
+  {
+    return NULL;
+  }
+  if (deck_size > 0)
+  {
+    memcpy(game->deck, deck, deck_size);
+  }
+  startTurns(&game->machine, game->deck, deck_size, &game->events);
+  return game;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Releases a game.
+/// @param game A pointer to the game, or NULL.
+void espFreeGame(EspGame *game)
+{
+  free(game);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Applies an action of the player to move. A play needs a card of the player's hand and a claim of an existing
+/// card. A challenge of a player who has not played in the round is refused by the rules and starts a new round,
+/// like in the terminal game.
+/// @param game A pointer to the game.
+/// @param action A pointer to the action. challenge_value is 1 to challenge the value and 0 for the spice.
+/// @return ESP_OK if the action was applied and its events replaced the previous ones; ESP_INVALID_ACTION if the
+/// play is not possible or the type is unknown; ESP_GAME_OVER if the game is already over. The game is unchanged
+/// unless ESP_OK is returned.
+int espApplyAction(EspGame *game, const Action *action)
+{
+  TurnMachine *machine = &game->machine;
+  if (machine->expect == EXPECT_NOTHING)
+  {
+    return ESP_GAME_OVER;
+  }
+
+  TurnCommand command;
+  memset(&command, 0, sizeof(command));
+  command.error = TURN_OK;
+  command.has_cards = 1;
+  command.action = *action;
+  command.action.challenge_value = action->challenge_value != 0;
+  switch (action->type)
+  {
+    case ACTION_PLAY:
+    {
+      int card = cardIndex(action->hand_value, action->hand_spice);
+      if (card < 0 || cardIndex(action->claimed_value, action->claimed_spice) < 0 ||
+          !handHolds(&machine->state.players[machine->state.seat].hand, card))
+      {
+        return ESP_INVALID_ACTION;
+      }
+      command.command = COMMAND_PLAY;
+      break;
+    }
+    case ACTION_CHALLENGE:
+      command.command = COMMAND_CHALLENGE;
+      break;
+    case ACTION_DRAW:
+      command.command = COMMAND_DRAW;
+      break;
+    default:
+      return ESP_INVALID_ACTION;
+  }
+
+  stepTurn(machine, &command, &game->events);
+  return ESP_OK;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Takes a snapshot of a game.
+/// @param game A pointer to the game.
+/// @param state A pointer to the snapshot to fill in.
+void espQueryState(const EspGame *game, EspState *state)
+{
+  const GameState *current = &game->machine.state;
+  const Player *players = current->players;
+  memset(state, 0, sizeof(*state));
+  state->seat = current->seat;
+  state->over = game->machine.expect == EXPECT_NOTHING;
+  if (state->over)
+  {
+    state->winner = players[0].score > players[1].score ? 1 : players[1].score > players[0].score ? 2 : 0;
+  }
+  for (int seat = 0; seat < 2; seat++)
+  {
+    state->scores[seat] = players[seat].score;
+    state->has_played[seat] = players[seat].has_played;
+    memcpy(state->hands[seat], players[seat].hand.counts, sizeof(state->hands[seat]));
+    state->hand_sizes[seat] = players[seat].hand.size;
+  }
+  state->pile_count = pileCount(&current->draw_pile);
+  state->cards_played_this_round = current->cards_played_this_round;
+  state->claimed_value = current->latest_card_number;
+  state->claimed_spice = (char)current->latest_card_spice;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Gives access to the events of the latest successful espApplyAction, or of espCreateGame before the first one.
+/// @param game A pointer to the game.
+/// @param events A pointer to the variable receiving the events, which stay valid until the next action.
+/// @return The number of events.
+int espEvents(const EspGame *game, const TurnEvent **events)
+{
+  *events = game->events.events;
+  return game->events.count;
+}
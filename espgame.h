@@ -0,0 +1,53 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Embeddable engine of "Entertaining Spice Pretending".
+//
+// The C API of the library built by "make lib": a game is created from a deck buffer, takes one action of the
+// player to move at a time, and can be asked for its state and for the events of the latest action. The library
+// consists of this file and the rule core (engine, state, tracker and turn), none of which reads input or prints
+// anything, so it can be linked into any process. The terminal game, the server and the simulations are front
+// ends over the same rule core.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef ESPGAME_H
+#define ESPGAME_H
+
+#include <stdint.h>
+
+#include "turn.h"
+
+#define ESP_OK 0
+#define ESP_INVALID_ACTION 1
+#define ESP_GAME_OVER 2
+
+typedef struct EspGame EspGame;
+
+// A snapshot of a game. seat is the player to move, 0 for player 1 and 1 for player 2. winner is set once the game
+// is over: 1 or 2 for the player with more points, 0 for a tie. claimed_value and claimed_spice are the latest claim
+// of the game, or 0 and '\0' before the first play; has_played tells whether it belongs to the current round.
+typedef struct EspState
+{
+  int seat;
+  int over;
+  int winner;
+  int scores[2];
+  int has_played[2];
+  uint16_t hands[2][CARD_KINDS];
+  int hand_sizes[2];
+  int pile_count;
+  int cards_played_this_round;
+  int claimed_value;
+  char claimed_spice;
+} EspState;
+
+EspGame *espCreateGame(const uint8_t *deck, int deck_size);
+void espFreeGame(EspGame *game);
+int espApplyAction(EspGame *game, const Action *action);
+void espQueryState(const EspGame *game, EspState *state);
+int espEvents(const EspGame *game, const TurnEvent **events);
+
+#endif
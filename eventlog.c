@@ -0,0 +1,593 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Binary game-event log of "Entertaining Spice Pretending" and its replay verifier.
+//
+// Records are collected in a 64 KiB buffer and written with one fwrite whenever it is full, so logging a game costs
+// a few stores per event. The replay reads the log through a buffer of the same size, re-executes every event with
+// the rule functions of engine.c and compares the challenge outcomes and final scores with the recorded ones.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "eventlog.h"
+#include "simulate.h"
+
+static const unsigned char LOG_HEADER[] = {'E', 'S', 'P', 'L', 1};
+
+// Number of mismatching games that are described in detail by the replay.
+#define REPORTED_MISMATCHES 10
+
+typedef struct EventReader
+{
+  FILE *file;
+  size_t position;
+  size_t length;
+  unsigned char buffer[EVENT_LOG_BUFFER_SIZE];
+} EventReader;
+
+typedef struct ReplayState
+{
+  Player players[2];
+  DrawPile draw_pile;
+  int cards_played_this_round;
+  int latest_card_number;
+  int latest_card_spice;
+  const char *mismatch;
+} ReplayState;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes the buffered records of a log to its file.
+/// @param log A pointer to the log.
+static void flushEventLog(EventLog *log)
+{
+  if (log->used > 0 && fwrite(log->buffer, 1, log->used, log->file) != log->used)
+  {
+    log->failed = 1;
+  }
+  log->used = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Appends one byte to a log.
+/// @param log A pointer to the log.
+/// @param byte The byte to append.
+static inline void putByte(EventLog *log, unsigned byte)
+{
+  if (log->used == EVENT_LOG_BUFFER_SIZE)
+  {
+    flushEventLog(log);
+  }
+  log->buffer[log->used++] = (unsigned char)byte;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Appends an unsigned number to a log in 7-bit groups, so small numbers take a single byte.
+/// @param log A pointer to the log.
+/// @param value The number to append.
+static void putVarint(EventLog *log, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    putByte(log, (value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  putByte(log, value);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Creates a log file and writes its header.
+/// @param path The path of the log file.
+/// @return A pointer to the log, or NULL if the file cannot be created or there is not enough memory.
+EventLog *openEventLog(const char *path)
+{
+  EventLog *log = malloc(sizeof(EventLog));
+  if (!log)
+  {
+    return NULL;
+  }
+
+  log->file = fopen(path, "wb");
+  if (!log->file)
+  {
+    free(log);
+    return NULL;
+  }
+  log->used = 0;
+  log->failed = 0;
+
+  for (size_t i = 0; i < sizeof(LOG_HEADER); i++)
+  {
+    putByte(log, LOG_HEADER[i]);
+  }
+  return log;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes the remaining records of a log, closes its file and frees it.
+/// @param log A pointer to the log, may be NULL.
+/// @return 0 if every record was written; 1 otherwise.
+int closeEventLog(EventLog *log)
+{
+  if (!log)
+  {
+    return 0;
+  }
+
+  flushEventLog(log);
+  int failed = fclose(log->file) != 0 || log->failed;
+  free(log);
+  return failed;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Records the start of a game with its deck in dealing order.
+/// @param log A pointer to the log, or NULL if no log is written.
+/// @param kinds The kind indices of the cards of the deck.
+/// @param size The number of cards in the deck.
+void logDeal(EventLog *log, const uint8_t *kinds, int size)
+{
+  if (!log)
+  {
+    return;
+  }
+
+  putByte(log, EVENT_DEAL);
+  putVarint(log, size);
+  for (int i = 0; i < size; i++)
+  {
+    putByte(log, kinds[i]);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Records a played card together with the card it is claimed to be.
+/// @param log A pointer to the log, or NULL if no log is written.
+/// @param seat The seat of the player, 0 for player 1 and 1 for player 2.
+/// @param hand_index The kind index of the played card.
+/// @param claimed_value The claimed value.
+/// @param claimed_spice The claimed spice.
+void logPlay(EventLog *log, int seat, int hand_index, int claimed_value, char claimed_spice)
+{
+  if (!log)
+  {
+    return;
+  }
+
+  int claimed_index = cardIndex(claimed_value, claimed_spice);
+  if (claimed_index >= 0)
+  {
+    putByte(log, EVENT_PLAY | (seat ? EVENT_SEAT : 0));
+    putByte(log, hand_index);
+    putByte(log, claimed_index);
+    return;
+  }
+
+  putByte(log, EVENT_PLAY | (seat ? EVENT_SEAT : 0) | EVENT_FLAG_ESCAPED);
+  putByte(log, hand_index);
+  putVarint(log, ((uint32_t)claimed_value << 1) ^ (uint32_t)(claimed_value < 0 ? -1 : 0));
+  putByte(log, (unsigned char)claimed_spice);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Records a card drawn from the draw pile.
+/// @param log A pointer to the log, or NULL if no log is written.
+/// @param seat The seat of the player, 0 for player 1 and 1 for player 2.
+/// @param index The kind index of the drawn card.
+void logDraw(EventLog *log, int seat, int index)
+{
+  if (!log)
+  {
+    return;
+  }
+
+  putByte(log, EVENT_DRAW | (seat ? EVENT_SEAT : 0));
+  putByte(log, index);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Records a resolved challenge with its type and outcome.
+/// @param log A pointer to the log, or NULL if no log is written.
+/// @param seat The seat of the challenger, 0 for player 1 and 1 for player 2.
+/// @param challenge_value 1 for a challenge on the value; 0 for a challenge on the spice.
+/// @param result A pointer to the outcome returned by resolveChallenge.
+void logChallenge(EventLog *log, int seat, int challenge_value, const ChallengeResult *result)
+{
+  if (!log)
+  {
+    return;
+  }
+
+  putByte(log, EVENT_CHALLENGE | (seat ? EVENT_SEAT : 0) | (challenge_value ? EVENT_FLAG_VALUE : 0) |
+               (result->successful ? EVENT_FLAG_SUCCESSFUL : 0) | (result->bonus ? EVENT_FLAG_BONUS : 0));
+  putVarint(log, result->points);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Records the end of a game with the final scores.
+/// @param log A pointer to the log, or NULL if no log is written.
+/// @param score1 The score of player 1.
+/// @param score2 The score of player 2.
+void logEnd(EventLog *log, int score1, int score2)
+{
+  if (!log)
+  {
+    return;
+  }
+
+  putByte(log, EVENT_END);
+  putVarint(log, score1);
+  putVarint(log, score2);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads the next byte of a log.
+/// @param reader A pointer to the reader.
+/// @return The byte, or -1 at the end of the file.
+static inline int readByte(EventReader *reader)
+{
+  if (reader->position == reader->length)
+  {
+    reader->length = fread(reader->buffer, 1, EVENT_LOG_BUFFER_SIZE, reader->file);
+    reader->position = 0;
+    if (reader->length == 0)
+    {
+      return -1;
+    }
+  }
+  return reader->buffer[reader->position++];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads a number written by putVarint.
+/// @param reader A pointer to the reader.
+/// @param value A pointer to the variable receiving the number.
+/// @return 0 if the number was read; 1 if the log ends early or the number is too long.
+static int readVarint(EventReader *reader, uint32_t *value)
+{
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7)
+  {
+    int byte = readByte(reader);
+    if (byte < 0)
+    {
+      return 1;
+    }
+    result |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+    {
+      *value = result;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads a kind index byte.
+/// @param reader A pointer to the reader.
+/// @return The kind index, or -1 if the log ends early or the byte is not a kind index.
+static int readKind(EventReader *reader)
+{
+  int index = readByte(reader);
+  return index < CARD_KINDS ? index : -1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Re-executes a play event.
+/// @param reader A pointer to the reader positioned after the opcode.
+/// @param state A pointer to the state of the replayed game.
+/// @param opcode The opcode of the event.
+/// @return 0 if the event was read; 1 if the log is corrupt.
+static int replayPlay(EventReader *reader, ReplayState *state, int opcode)
+{
+  int hand_index = readKind(reader);
+  int claimed_value;
+  char claimed_spice;
+
+  if (opcode & EVENT_FLAG_ESCAPED)
+  {
+    uint32_t zigzag;
+    int spice;
+    if (readVarint(reader, &zigzag) != 0 || (spice = readByte(reader)) < 0)
+    {
+      return 1;
+    }
+    claimed_value = (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+    claimed_spice = (char)spice;
+  }
+  else
+  {
+    int claimed_index = readKind(reader);
+    if (claimed_index < 0)
+    {
+      return 1;
+    }
+    claimed_value = cardValue(claimed_index);
+    claimed_spice = cardSpice(claimed_index);
+  }
+
+  if (hand_index < 0)
+  {
+    return 1;
+  }
+
+  Player *current_player = &state->players[(opcode & EVENT_SEAT) != 0];
+  if (!state->mismatch &&
+      playCard(current_player, cardValue(hand_index), cardSpice(hand_index), claimed_value, claimed_spice,
+               &state->cards_played_this_round, &state->latest_card_number, &state->latest_card_spice) != 0)
+  {
+    state->mismatch = "played card is not in the hand";
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Re-executes a draw event.
+/// @param reader A pointer to the reader positioned after the opcode.
+/// @param state A pointer to the state of the replayed game.
+/// @param opcode The opcode of the event.
+/// @return 0 if the event was read; 1 if the log is corrupt.
+static int replayDraw(EventReader *reader, ReplayState *state, int opcode)
+{
+  int index = readKind(reader);
+  if (index < 0)
+  {
+    return 1;
+  }
+
+  if (state->mismatch)
+  {
+    return 0;
+  }
+  if (pileIsEmpty(&state->draw_pile))
+  {
+    state->mismatch = "draw from an empty draw pile";
+  }
+  else if (pilePeek(&state->draw_pile, 0) != index)
+  {
+    state->mismatch = "drawn card differs";
+  }
+  else
+  {
+    drawCard(&state->players[(opcode & EVENT_SEAT) != 0], &state->draw_pile);
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Re-executes a challenge event and compares its outcome with the recorded one.
+/// @param reader A pointer to the reader positioned after the opcode.
+/// @param state A pointer to the state of the replayed game.
+/// @param opcode The opcode of the event.
+/// @return 0 if the event was read; 1 if the log is corrupt.
+static int replayChallenge(EventReader *reader, ReplayState *state, int opcode)
+{
+  uint32_t points;
+  if (readVarint(reader, &points) != 0)
+  {
+    return 1;
+  }
+
+  if (state->mismatch)
+  {
+    return 0;
+  }
+
+  int seat = (opcode & EVENT_SEAT) != 0;
+  if (!state->players[1 - seat].has_played)
+  {
+    state->mismatch = "challenge without a played card";
+    return 0;
+  }
+
+  ChallengeResult result;
+  resolveChallenge(&state->players[seat], &state->players[1 - seat], (opcode & EVENT_FLAG_VALUE) != 0,
+                   &state->cards_played_this_round, &state->draw_pile, &result);
+
+  if (!result.successful != !(opcode & EVENT_FLAG_SUCCESSFUL))
+  {
+    state->mismatch = "challenge outcome differs";
+  }
+  else if ((uint32_t)result.points != points)
+  {
+    state->mismatch = "challenge points differ";
+  }
+  else if (!result.bonus != !(opcode & EVENT_FLAG_BONUS))
+  {
+    state->mismatch = "bonus differs";
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Replays the events of one game up to and including its end event.
+/// @param reader A pointer to the reader positioned after the deal event.
+/// @param state A pointer to the state of the replayed game, already dealt.
+/// @param events A pointer to the counter of replayed events.
+/// @return 0 if the game was read completely; 1 if the log is corrupt.
+static int replayEvents(EventReader *reader, ReplayState *state, long long *events)
+{
+  for (;;)
+  {
+    int opcode = readByte(reader);
+    if (opcode < 0)
+    {
+      return 1;
+    }
+    (*events)++;
+
+    int corrupt;
+    switch (opcode & EVENT_TYPE_MASK)
+    {
+      case EVENT_PLAY:
+        corrupt = replayPlay(reader, state, opcode);
+        break;
+      case EVENT_DRAW:
+        corrupt = replayDraw(reader, state, opcode);
+        break;
+      case EVENT_CHALLENGE:
+        corrupt = replayChallenge(reader, state, opcode);
+        break;
+      case EVENT_END:
+      {
+        uint32_t score1, score2;
+        if (readVarint(reader, &score1) != 0 || readVarint(reader, &score2) != 0)
+        {
+          return 1;
+        }
+        if (!state->mismatch && ((uint32_t)state->players[0].score != score1 ||
+                                 (uint32_t)state->players[1].score != score2))
+        {
+          state->mismatch = "final scores differ";
+        }
+        return 0;
+      }
+      default:
+        return 1;
+    }
+
+    if (corrupt)
+    {
+      return 1;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Entry point of the replay mode started with "--replay".
+/// Re-executes every game of an event log with the rule functions and reports the games whose challenges or final
+/// scores differ from the recorded ones.
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// @return 0 if every game matches; 1 for invalid arguments; 2 if the log cannot be opened; 3 if the log is not a
+/// valid event log; 4 if there is not enough memory; 5 if a game does not match.
+int runReplay(int argc, char *argv[])
+{
+  if (argc != 3)
+  {
+    printf("Usage: ./a4-csf --replay <log file>\n");
+    return 1;
+  }
+
+  const char *log_path = argv[2];
+  EventReader *reader = malloc(sizeof(EventReader));
+  if (!reader)
+  {
+    printf("Error: Out of memory\n");
+    return 4;
+  }
+  reader->file = fopen(log_path, "rb");
+  reader->position = 0;
+  reader->length = 0;
+  if (!reader->file)
+  {
+    printf("Error: Cannot open file: %s\n", log_path);
+    free(reader);
+    return 2;
+  }
+
+  int status = 0;
+  for (size_t i = 0; i < sizeof(LOG_HEADER); i++)
+  {
+    if (readByte(reader) != LOG_HEADER[i])
+    {
+      status = 3;
+    }
+  }
+
+  uint8_t *kinds = NULL;
+  uint32_t capacity = 0;
+  long long games = 0;
+  long long events = 0;
+  long long mismatches = 0;
+  double start = currentSeconds();
+
+  while (status == 0)
+  {
+    int opcode = readByte(reader);
+    uint32_t size;
+    if (opcode < 0)
+    {
+      break;
+    }
+    if (opcode != EVENT_DEAL || readVarint(reader, &size) != 0)
+    {
+      status = 3;
+      break;
+    }
+
+    if (size > capacity)
+    {
+      free(kinds);
+      capacity = size;
+      kinds = malloc(capacity);
+      if (!kinds)
+      {
+        status = 4;
+        break;
+      }
+    }
+    for (uint32_t i = 0; i < size && status == 0; i++)
+    {
+      int index = readKind(reader);
+      if (index < 0)
+      {
+        status = 3;
+      }
+      kinds[i] = (uint8_t)index;
+    }
+    if (status != 0)
+    {
+      break;
+    }
+
+    ReplayState state = {{{{0, 0, {0}}, 0, 0, {0, '\0'}, {0, '\0'}}, {{0, 0, {0}}, 0, 0, {0, '\0'}, {0, '\0'}}},
+                         {NULL, 0, 0}, 0, 0, '\0', NULL};
+    distributeCards(kinds, (int)size, &state.players[0], &state.players[1], &state.draw_pile);
+    events++;
+
+    if (replayEvents(reader, &state, &events) != 0)
+    {
+      status = 3;
+      break;
+    }
+
+    if (state.mismatch)
+    {
+      if (mismatches < REPORTED_MISMATCHES)
+      {
+        printf("Mismatch in game %lld: %s\n", games + 1, state.mismatch);
+      }
+      mismatches++;
+    }
+    games++;
+  }
+
+  double elapsed = currentSeconds() - start;
+  fclose(reader->file);
+  free(reader);
+  free(kinds);
+
+  if (status == 3)
+  {
+    printf("Error: Invalid event log: %s\n", log_path);
+    return 3;
+  }
+  if (status == 4)
+  {
+    printf("Error: Out of memory\n");
+    return 4;
+  }
+
+  printf("Replayed %lld games (%lld events) of %s in %.3f s (%.0f events/s)\n", games, events, log_path, elapsed,
+         elapsed > 0 ? events / elapsed : 0.0);
+  printf("Verified: %lld, mismatches: %lld\n", games - mismatches, mismatches);
+  return mismatches ? 5 : 0;
+}
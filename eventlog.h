@@ -0,0 +1,62 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Binary game-event log of "Entertaining Spice Pretending" and its replay verifier.
+//
+// Every state change of a game (deal, play, draw, challenge and final scores) is written as a record of a few bytes
+// into a buffered stream. A log can hold any number of games and is replayed against the rule functions of engine.c
+// to verify that the engine still produces the same outcomes.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "engine.h"
+
+#define EVENT_LOG_BUFFER_SIZE 65536
+
+// Record layout: one opcode byte followed by the operands of its event type.
+//   EVENT_DEAL       varint deck size, one kind index byte per card in dealing order
+//   EVENT_PLAY       real kind index byte, claimed kind index byte (or, with EVENT_FLAG_ESCAPED, the claimed value as
+//                    zigzag varint and the claimed spice byte for claims that are not a real card)
+//   EVENT_DRAW       drawn kind index byte
+//   EVENT_CHALLENGE  varint points
+//   EVENT_END        varint score of player 1, varint score of player 2
+#define EVENT_DEAL 0
+#define EVENT_PLAY 1
+#define EVENT_DRAW 2
+#define EVENT_CHALLENGE 3
+#define EVENT_END 4
+
+#define EVENT_TYPE_MASK 0x07
+#define EVENT_SEAT 0x08
+#define EVENT_FLAG_VALUE 0x10
+#define EVENT_FLAG_ESCAPED 0x10
+#define EVENT_FLAG_SUCCESSFUL 0x20
+#define EVENT_FLAG_BONUS 0x40
+
+typedef struct EventLog
+{
+  FILE *file;
+  size_t used;
+  int failed;
+  unsigned char buffer[EVENT_LOG_BUFFER_SIZE];
+} EventLog;
+
+EventLog *openEventLog(const char *path);
+int closeEventLog(EventLog *log);
+void logDeal(EventLog *log, const uint8_t *kinds, int size);
+void logPlay(EventLog *log, int seat, int hand_index, int claimed_value, char claimed_spice);
+void logDraw(EventLog *log, int seat, int index);
+void logChallenge(EventLog *log, int seat, int challenge_value, const ChallengeResult *result);
+void logEnd(EventLog *log, int score1, int score2);
+int runReplay(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,837 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Seat fairness analysis of the decks of "Entertaining Spice Pretending".
+//
+// A deal of distributeCards is a hand for each player and the order of the draw pile. Hands are sets of card kinds
+// with counts, so the exact analysis enumerates each pair of hands once as a pair of multisets, weighted by the
+// number of deck orders that deal it. The draw pile is not enumerated up front: a game is played until it needs a
+// card of the pile that is not yet known, and then continues once per kind that can still be on that position,
+// weighted by how many cards of the kind are left. All orders of the pile that agree on the cards drawn so far
+// share the game up to that point, and orders that differ only after the game ended are never visited. This needs
+// strategies that decide the same in the same position; the random generator of the strategies is therefore part
+// of the position, seeded anew for every pair of hands, and random strategies play the pairs of hands of small
+// decks several times, so that every analysis plays at least DEFAULT_SAMPLES games.
+// The pairs of hands are spread over all cores, one first hand per job of the work-stealing pool.
+//
+// Decks with too many deals are sampled instead, stratified by how many cards of each hand are above the median
+// value of the deck: the weight of every stratum is known exactly, each stratum gets its share of the games, and
+// the deals of a stratum are drawn by shuffling the high and the low cards separately.
+//
+// Every job adds into its own totals, which are merged in the order of the jobs, so the results do not depend on
+// the number of threads.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "deckgen.h"
+#include "fairness.h"
+#include "pool.h"
+#include "simulate.h"
+#include "state.h"
+#include "tracker.h"
+
+#define DEFAULT_SAMPLES 1000000
+#define GAMES_PER_JOB 512
+
+// Decks with more deals than this, or with a draw pile larger than MAX_EXACT_PILE, are sampled.
+#define MAX_EXACT_DEALS 1e9
+#define MAX_EXACT_PILE 20
+
+typedef struct FairnessTotals
+{
+  double weight;
+  double wins[3];
+  double score[2];
+  double turns;
+  long long deals;
+} FairnessTotals;
+
+// The deals with highs[0] cards above the median value in the hand of player 1 and highs[1] in that of player 2.
+typedef struct Stratum
+{
+  int highs[2];
+  double weight;
+  long long games;
+} Stratum;
+
+// A job is one first hand of the exact analysis, or a chunk of games of one stratum.
+typedef struct FairnessJob
+{
+  int index;
+  int games;
+} FairnessJob;
+
+typedef struct Fairness
+{
+  Seat seats[2];
+  Deck deck;
+  uint16_t deck_counts[CARD_KINDS];
+  int cards_from[CARD_KINDS + 1];
+  int hand_sizes[2];
+  int dealt;
+  int draws;
+  uint8_t (*first_hands)[CARD_KINDS];
+  uint8_t *sorted_cards;
+  int high_count;
+  Stratum *strata;
+  int stratum_count;
+  FairnessJob *jobs;
+  int job_count;
+  FairnessTotals *job_totals;
+  uint8_t **worker_decks;
+  uint64_t seed;
+} Fairness;
+
+// The deal a job is exploring. Positions of deck up to assigned are known; remaining counts the other cards.
+typedef struct Exploration
+{
+  const Fairness *fairness;
+  uint8_t *deck;
+  uint8_t available[CARD_KINDS];
+  int available_from[CARD_KINDS + 1];
+  uint16_t remaining[CARD_KINDS];
+  int remaining_count;
+  int assigned;
+  uint64_t rng;
+  FairnessTotals *totals;
+} Exploration;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns a binomial coefficient as a floating point number.
+/// @param n The size of the set.
+/// @param k The size of the subsets.
+/// @return The number of subsets of k of n elements, or 0 if k is out of range.
+static double binomial(int n, int k)
+{
+  if (k < 0 || k > n)
+  {
+    return 0.0;
+  }
+  double result = 1.0;
+  for (int i = 1; i <= k; i++)
+  {
+    result = result * (n - k + i) / i;
+  }
+  return result;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds the outcome of a finished game to the totals of a job.
+/// @param totals A pointer to the totals.
+/// @param players The players at the end of the game.
+/// @param turns The number of turns of the game.
+/// @param weight The probability of the deal, or 1 for a sampled deal.
+static void addOutcome(FairnessTotals *totals, const Player players[2], int turns, double weight)
+{
+  int winner = players[0].score > players[1].score ? 1 : players[1].score > players[0].score ? 2 : 0;
+  totals->weight += weight;
+  totals->wins[winner] += weight;
+  totals->score[0] += weight * players[0].score;
+  totals->score[1] += weight * players[1].score;
+  totals->turns += weight * turns;
+  totals->deals++;
+}
+
+static void explore(Exploration *exploration, const GameState *position, const CardTracker position_trackers[2],
+                    uint64_t position_rng, double weight, int turns);
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Continues a game once for every kind of card that can be on the next unknown position of the draw pile.
+/// @param exploration A pointer to the deal being explored.
+/// @param state A pointer to the state of the game before the move that needs the card.
+/// @param trackers The card counts of both players in that state.
+/// @param rng The state of the random generator of the strategies before the move.
+/// @param weight The probability of reaching the state.
+/// @param turns The number of turns played so far.
+static void branchPile(Exploration *exploration, const GameState *state, const CardTracker trackers[2], uint64_t rng,
+                       double weight, int turns)
+{
+  int position = exploration->assigned++;
+  for (int kind = 0; kind < CARD_KINDS; kind++)
+  {
+    if (exploration->remaining[kind] == 0)
+    {
+      continue;
+    }
+    double share = weight * exploration->remaining[kind] / exploration->remaining_count;
+    exploration->deck[position] = (uint8_t)kind;
+    exploration->remaining[kind]--;
+    exploration->remaining_count--;
+    explore(exploration, state, trackers, rng, share, turns);
+    exploration->remaining[kind]++;
+    exploration->remaining_count++;
+  }
+  exploration->assigned--;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays a game from a position to its end with the strategies of both seats, mirroring simulateTurn, and adds
+/// its outcome to the totals. If a move takes a card of the draw pile that is not known yet, the game branches.
+/// @param exploration A pointer to the deal being explored.
+/// @param position A pointer to the state to start from, which is not modified.
+/// @param position_trackers The card counts of both players in that state.
+/// @param position_rng The state of the random generator of the strategies.
+/// @param weight The probability of reaching the state.
+/// @param turns The number of turns played so far.
+static void explore(Exploration *exploration, const GameState *position, const CardTracker position_trackers[2],
+                    uint64_t position_rng, double weight, int turns)
+{
+  const Seat *seats = exploration->fairness->seats;
+  GameState state;
+  cloneGameState(&state, position);
+  CardTracker trackers[2] = {position_trackers[0], position_trackers[1]};
+  uint64_t rng = position_rng;
+
+  while (!gameStateOver(&state))
+  {
+    uint64_t turn_rng = rng;
+    int seat_index = state.seat;
+    TurnView view = {&state.players[seat_index], &state.players[1 - seat_index], &state.draw_pile,
+                     state.cards_played_this_round, state.latest_card_number, state.latest_card_spice, &rng,
+                     exploration->fairness->deck_counts, &trackers[seat_index], seat_index};
+    Action action = {ACTION_DRAW, 0, '\0', 0, '\0', 0};
+    seats[seat_index].decide(&view, &action, seats[seat_index].context);
+    if (!isLegalMove(&state, &action))
+    {
+      action.type = ACTION_DRAW;
+    }
+
+    int taken = action.type == ACTION_DRAW ? 1 : action.type == ACTION_CHALLENGE ? STANDARD_PENALTY_CARDS : 0;
+    int end = taken < pileCount(&state.draw_pile) ? state.draw_pile.top + taken : state.draw_pile.size;
+    if (end > exploration->assigned)
+    {
+      branchPile(exploration, &state, trackers, turn_rng, weight, turns);
+      return;
+    }
+
+    MoveUndo undo;
+    applyMove(&state, &action, &undo);
+    trackMove(trackers, &state, &undo);
+    turns++;
+  }
+
+  addOutcome(exploration->totals, state.players, turns, weight);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Explores all games of a pair of hands, dealt into the deck positions distributeCards gives them, once for every
+/// draw of the decisions of random strategies.
+/// @param exploration A pointer to the exploration of the job.
+/// @param first The number of cards of each kind in the hand of player 1.
+/// @param second The number of cards of each kind in the hand of player 2.
+/// @param weight The probability that distributeCards deals the two hands.
+static void exploreHands(Exploration *exploration, const uint8_t *first, const uint8_t *second, double weight)
+{
+  const Fairness *fairness = exploration->fairness;
+  int slots[2] = {0, 1};
+  for (int kind = 0; kind < CARD_KINDS; kind++)
+  {
+    for (int i = 0; i < first[kind]; i++, slots[0] += 2)
+    {
+      exploration->deck[slots[0]] = (uint8_t)kind;
+    }
+    for (int i = 0; i < second[kind]; i++, slots[1] += 2)
+    {
+      exploration->deck[slots[1]] = (uint8_t)kind;
+    }
+    exploration->remaining[kind] = (uint16_t)(fairness->deck_counts[kind] - first[kind] - second[kind]);
+  }
+  exploration->remaining_count = fairness->deck.size - fairness->dealt;
+  exploration->assigned = fairness->dealt;
+
+  GameState state;
+  initGameState(&state, exploration->deck, fairness->deck.size, NULL);
+  CardTracker trackers[2];
+  startTracker(&trackers[0], fairness->deck_counts, &state.players[0].hand);
+  startTracker(&trackers[1], fairness->deck_counts, &state.players[1].hand);
+  for (int draw = 0; draw < fairness->draws; draw++)
+  {
+    explore(exploration, &state, trackers, nextRandom(&exploration->rng), weight / fairness->draws, 0);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Explores every hand of player 2 that can be dealt with a hand of player 1, choosing the count of one kind per
+/// call.
+/// @param exploration A pointer to the exploration of the job, whose available cards are those not in the first hand.
+/// @param first The number of cards of each kind in the hand of player 1.
+/// @param second The hand of player 2 chosen so far.
+/// @param kind The kind to choose the count of.
+/// @param left The number of cards still to choose.
+/// @param weight The probability of the first hand times the ways to choose the counts so far.
+static void exploreSecondHands(Exploration *exploration, const uint8_t *first, uint8_t *second, int kind, int left,
+                               double weight)
+{
+  if (left == 0)
+  {
+    exploreHands(exploration, first, second, weight / binomial(exploration->fairness->deck.size -
+                                                                 exploration->fairness->hand_sizes[0],
+                                                                 exploration->fairness->hand_sizes[1]));
+    return;
+  }
+  if (kind == CARD_KINDS || left > exploration->available_from[kind])
+  {
+    return;
+  }
+
+  int most = exploration->available[kind] < left ? exploration->available[kind] : left;
+  for (int count = 0; count <= most; count++)
+  {
+    second[kind] = (uint8_t)count;
+    exploreSecondHands(exploration, first, second, kind + 1, left - count,
+                       weight * binomial(exploration->available[kind], count));
+  }
+  second[kind] = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Lists every hand of player 1 as the number of cards of each kind, choosing the count of one kind per call.
+/// @param fairness A pointer to the analysis.
+/// @param hand The hand chosen so far.
+/// @param kind The kind to choose the count of.
+/// @param left The number of cards still to choose.
+/// @param list The array receiving the hands, or NULL to only count them.
+/// @param count The number of hands listed so far.
+/// @return The number of hands listed including the new ones.
+static int listFirstHands(const Fairness *fairness, uint8_t *hand, int kind, int left, uint8_t (*list)[CARD_KINDS],
+                          int count)
+{
+  if (left == 0)
+  {
+    if (list)
+    {
+      memcpy(list[count], hand, CARD_KINDS);
+    }
+    return count + 1;
+  }
+  if (kind == CARD_KINDS || left > fairness->cards_from[kind])
+  {
+    return count;
+  }
+
+  int most = fairness->deck_counts[kind] < left ? fairness->deck_counts[kind] : left;
+  for (int taken = 0; taken <= most; taken++)
+  {
+    hand[kind] = (uint8_t)taken;
+    count = listFirstHands(fairness, hand, kind + 1, left - taken, list, count);
+  }
+  hand[kind] = 0;
+  return count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Explores all deals with one hand of player 1.
+/// @param fairness A pointer to the analysis.
+/// @param first The number of cards of each kind in the hand of player 1.
+/// @param seed The seed of the job.
+/// @param deck The array of twice the deck size owned by the worker.
+/// @param totals A pointer to the totals of the job.
+static void runExactJob(const Fairness *fairness, const uint8_t *first, uint64_t seed, uint8_t *deck,
+                        FairnessTotals *totals)
+{
+  Exploration exploration;
+  exploration.fairness = fairness;
+  exploration.deck = deck;
+  exploration.rng = seed;
+  exploration.totals = totals;
+  exploration.available_from[CARD_KINDS] = 0;
+  double weight = 1.0 / binomial(fairness->deck.size, fairness->hand_sizes[0]);
+  for (int kind = CARD_KINDS - 1; kind >= 0; kind--)
+  {
+    exploration.available[kind] = (uint8_t)(fairness->deck_counts[kind] - first[kind]);
+    exploration.available_from[kind] = exploration.available_from[kind + 1] + exploration.available[kind];
+    weight *= binomial(fairness->deck_counts[kind], first[kind]);
+  }
+
+  uint8_t second[CARD_KINDS] = {0};
+  exploreSecondHands(&exploration, first, second, 0, fairness->hand_sizes[1], weight);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays the sampled games of a job. The deck is dealt with the number of high cards of the stratum in each hand,
+/// all else uniformly at random.
+/// @param fairness A pointer to the analysis.
+/// @param work A pointer to the job.
+/// @param seed The seed of the job.
+/// @param deck The array of twice the deck size owned by the worker.
+/// @param totals A pointer to the totals of the job.
+static void runSampleJob(const Fairness *fairness, const FairnessJob *work, uint64_t seed, uint8_t *deck,
+                         FairnessTotals *totals)
+{
+  const Stratum *stratum = &fairness->strata[work->index];
+  int size = fairness->deck.size;
+  int high_count = fairness->high_count;
+  uint8_t *cards = deck + size;
+  uint64_t rng = seed;
+
+  for (int game = 0; game < work->games; game++)
+  {
+    memcpy(cards, fairness->sorted_cards, size);
+    shuffleDeck(cards, high_count, &rng);
+    shuffleDeck(cards + high_count, size - high_count, &rng);
+
+    int next_high = 0;
+    int next_low = high_count;
+    for (int seat = 0; seat < 2; seat++)
+    {
+      int slot = seat;
+      for (int i = 0; i < fairness->hand_sizes[seat]; i++, slot += 2)
+      {
+        deck[slot] = i < stratum->highs[seat] ? cards[next_high++] : cards[next_low++];
+      }
+    }
+    int pile = fairness->dealt;
+    memcpy(deck + pile, cards + next_high, high_count - next_high);
+    pile += high_count - next_high;
+    memcpy(deck + pile, cards + next_low, size - next_low);
+    shuffleDeck(deck + fairness->dealt, size - fairness->dealt, &rng);
+
+    GameResult result;
+    playGame(deck, size, fairness->seats, NULL, &rng, &result, NULL, NULL);
+    Player players[2];
+    players[0].score = result.score[0];
+    players[1].score = result.score[1];
+    addOutcome(totals, players, result.turns, 1.0);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Runs one job of the analysis with the deck buffer of the worker.
+/// @param job The index of the job.
+/// @param worker The index of the worker.
+/// @param context A pointer to the analysis.
+static void runFairnessJob(int job, int worker, void *context)
+{
+  Fairness *fairness = context;
+  if (fairness->first_hands)
+  {
+    runExactJob(fairness, fairness->first_hands[job], deckSeed(fairness->seed, job), fairness->worker_decks[worker],
+                &fairness->job_totals[job]);
+  }
+  else
+  {
+    runSampleJob(fairness, &fairness->jobs[job], deckSeed(fairness->seed, job), fairness->worker_decks[worker],
+                 &fairness->job_totals[job]);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Counts the distinct deals of a deck: pairs of hands as multisets, each with every distinct order of the rest of
+/// the deck as draw pile.
+/// @param fairness A pointer to the analysis.
+/// @param hand_pairs A pointer to the variable receiving the number of pairs of hands.
+/// @return The number of deals.
+static double countDeals(const Fairness *fairness, double *hand_pairs)
+{
+  // pairs[a][b] and orders[a][b] sum over the ways to put a cards of the kinds so far in the first hand and b in the
+  // second; orders weighs each with 1 / r! for the r cards of every kind that are left for the pile.
+  double pairs[STANDARD_HAND_SIZE + 1][STANDARD_HAND_SIZE + 1] = {{0}};
+  double orders[STANDARD_HAND_SIZE + 1][STANDARD_HAND_SIZE + 1] = {{0}};
+  pairs[0][0] = 1.0;
+  orders[0][0] = 1.0;
+  int first_size = fairness->hand_sizes[0];
+  int second_size = fairness->hand_sizes[1];
+
+  for (int kind = 0; kind < CARD_KINDS; kind++)
+  {
+    int count = fairness->deck_counts[kind];
+    if (count == 0)
+    {
+      continue;
+    }
+    double next_pairs[STANDARD_HAND_SIZE + 1][STANDARD_HAND_SIZE + 1] = {{0}};
+    double next_orders[STANDARD_HAND_SIZE + 1][STANDARD_HAND_SIZE + 1] = {{0}};
+    for (int a = 0; a <= first_size; a++)
+    {
+      for (int b = 0; b <= second_size; b++)
+      {
+        for (int i = 0; i <= count && a + i <= first_size; i++)
+        {
+          for (int j = 0; i + j <= count && b + j <= second_size; j++)
+          {
+            next_pairs[a + i][b + j] += pairs[a][b];
+            next_orders[a + i][b + j] += orders[a][b] / tgamma(count - i - j + 1);
+          }
+        }
+      }
+    }
+    memcpy(pairs, next_pairs, sizeof(pairs));
+    memcpy(orders, next_orders, sizeof(orders));
+  }
+
+  *hand_pairs = pairs[first_size][second_size];
+  return orders[first_size][second_size] * tgamma(fairness->deck.size - fairness->dealt + 1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prepares the jobs of the exact analysis, one per hand of player 1.
+/// @param fairness A pointer to the analysis.
+/// @return 0 on success; 4 if there is not enough memory.
+static int prepareExact(Fairness *fairness)
+{
+  uint8_t hand[CARD_KINDS] = {0};
+  fairness->job_count = listFirstHands(fairness, hand, 0, fairness->hand_sizes[0], NULL, 0);
+  fairness->first_hands = malloc(sizeof(*fairness->first_hands) * fairness->job_count);
+  if (!fairness->first_hands)
+  {
+    return 4;
+  }
+  listFirstHands(fairness, hand, 0, fairness->hand_sizes[0], fairness->first_hands, 0);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prepares the strata and jobs of the sampled analysis. Every stratum with a weight above 0 gets its share of the
+/// samples, but at least two games, so that its variance can be estimated.
+/// @param fairness A pointer to the analysis.
+/// @param samples The number of games to play in total.
+/// @return 0 on success; 4 if there is not enough memory.
+static int prepareSample(Fairness *fairness, long long samples)
+{
+  int size = fairness->deck.size;
+  int values[CARD_VALUES + 1] = {0};
+  for (int i = 0; i < size; i++)
+  {
+    values[cardValue(fairness->deck.kinds[i])]++;
+  }
+  int median = 0;
+  for (int below = 0; below <= (size - 1) / 2; )
+  {
+    below += values[++median];
+  }
+
+  fairness->sorted_cards = malloc(size);
+  fairness->strata = malloc(sizeof(Stratum) * (STANDARD_HAND_SIZE + 1) * (STANDARD_HAND_SIZE + 1));
+  if (!fairness->sorted_cards || !fairness->strata)
+  {
+    return 4;
+  }
+  int next = 0;
+  for (int high = 1; high >= 0; high--)
+  {
+    for (int i = 0; i < size; i++)
+    {
+      if ((cardValue(fairness->deck.kinds[i]) > median) == high)
+      {
+        fairness->sorted_cards[next++] = fairness->deck.kinds[i];
+      }
+    }
+    if (high)
+    {
+      fairness->high_count = next;
+    }
+  }
+
+  int high_count = fairness->high_count;
+  int low_count = size - high_count;
+  int first_size = fairness->hand_sizes[0];
+  int second_size = fairness->hand_sizes[1];
+  double first_deals = binomial(size, first_size);
+  double second_deals = binomial(size - first_size, second_size);
+  long long job_count = 0;
+  for (int x = 0; x <= first_size; x++)
+  {
+    for (int y = 0; y <= second_size; y++)
+    {
+      double weight = binomial(high_count, x) * binomial(low_count, first_size - x) / first_deals *
+                      binomial(high_count - x, y) * binomial(low_count - first_size + x, second_size - y) /
+                      second_deals;
+      if (weight <= 0.0)
+      {
+        continue;
+      }
+      Stratum *stratum = &fairness->strata[fairness->stratum_count++];
+      stratum->highs[0] = x;
+      stratum->highs[1] = y;
+      stratum->weight = weight;
+      stratum->games = llround(samples * weight);
+      if (stratum->games < 2)
+      {
+        stratum->games = 2;
+      }
+      job_count += (stratum->games + GAMES_PER_JOB - 1) / GAMES_PER_JOB;
+    }
+  }
+
+  if (job_count > 1 << 30)
+  {
+    return 4;
+  }
+  fairness->job_count = (int)job_count;
+  fairness->jobs = malloc(sizeof(FairnessJob) * fairness->job_count);
+  if (!fairness->jobs)
+  {
+    return 4;
+  }
+  int job = 0;
+  for (int s = 0; s < fairness->stratum_count; s++)
+  {
+    for (long long first = 0; first < fairness->strata[s].games; first += GAMES_PER_JOB)
+    {
+      long long games = fairness->strata[s].games - first;
+      fairness->jobs[job].index = s;
+      fairness->jobs[job].games = (int)(games < GAMES_PER_JOB ? games : GAMES_PER_JOB);
+      job++;
+    }
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Releases everything owned by an analysis.
+/// @param fairness A pointer to the analysis.
+/// @param worker_count The number of workers.
+static void freeFairness(Fairness *fairness, int worker_count)
+{
+  for (int i = 0; fairness->worker_decks && i < worker_count; i++)
+  {
+    free(fairness->worker_decks[i]);
+  }
+  free(fairness->worker_decks);
+  free(fairness->first_hands);
+  free(fairness->sorted_cards);
+  free(fairness->strata);
+  free(fairness->jobs);
+  free(fairness->job_totals);
+  free(fairness->deck.kinds);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the results of the analysis of all deals, which are exact for deterministic strategies.
+/// @param fairness A pointer to the finished analysis.
+/// @param hand_pairs The number of pairs of hands.
+/// @param elapsed The seconds the analysis took.
+static void printExact(const Fairness *fairness, double hand_pairs, double elapsed)
+{
+  FairnessTotals total = {0.0, {0.0, 0.0, 0.0}, {0.0, 0.0}, 0.0, 0};
+  for (int job = 0; job < fairness->job_count; job++)
+  {
+    const FairnessTotals *part = &fairness->job_totals[job];
+    total.weight += part->weight;
+    total.turns += part->turns;
+    for (int i = 0; i < 3; i++)
+    {
+      total.wins[i] += part->wins[i];
+    }
+    total.score[0] += part->score[0];
+    total.score[1] += part->score[1];
+    total.deals += part->deals;
+  }
+
+  printf("All deals: %.0f pairs of hands, %lld games in %.3f s\n", hand_pairs, total.deals, elapsed);
+  if (!playsDeterministically(&fairness->seats[0]) || !playsDeterministically(&fairness->seats[1]))
+  {
+    printf("Random decisions are drawn %d times per deal\n", fairness->draws);
+  }
+  printf("Player 1 wins: %.4f%%\n", 100.0 * total.wins[1] / total.weight);
+  printf("Player 2 wins: %.4f%%\n", 100.0 * total.wins[2] / total.weight);
+  printf("Ties: %.4f%%\n", 100.0 * total.wins[0] / total.weight);
+  printf("Mean score: %.4f : %.4f\n", total.score[0] / total.weight, total.score[1] / total.weight);
+  printf("Mean turns: %.4f\n", total.turns / total.weight);
+  printf("First-player advantage: %+.4f percentage points\n", 100.0 * (total.wins[1] - total.wins[2]) / total.weight);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the results of the sampled analysis, weighting the mean of every stratum with the weight of the stratum.
+/// The confidence interval of the advantage adds up the variances of the strata.
+/// @param fairness A pointer to the finished analysis.
+/// @param elapsed The seconds the analysis took.
+static void printSample(const Fairness *fairness, double elapsed)
+{
+  double wins[3] = {0.0, 0.0, 0.0};
+  double score[2] = {0.0, 0.0};
+  double turns = 0.0;
+  double variance = 0.0;
+  long long games = 0;
+  int job = 0;
+  for (int s = 0; s < fairness->stratum_count; s++)
+  {
+    FairnessTotals total = {0.0, {0.0, 0.0, 0.0}, {0.0, 0.0}, 0.0, 0};
+    for (; job < fairness->job_count && fairness->jobs[job].index == s; job++)
+    {
+      const FairnessTotals *part = &fairness->job_totals[job];
+      total.weight += part->weight;
+      total.turns += part->turns;
+      for (int i = 0; i < 3; i++)
+      {
+        total.wins[i] += part->wins[i];
+      }
+      total.score[0] += part->score[0];
+      total.score[1] += part->score[1];
+    }
+
+    double weight = fairness->strata[s].weight / total.weight;
+    for (int i = 0; i < 3; i++)
+    {
+      wins[i] += weight * total.wins[i];
+    }
+    score[0] += weight * total.score[0];
+    score[1] += weight * total.score[1];
+    turns += weight * total.turns;
+
+    // The advantage of a game is 1 if player 1 wins, -1 if player 2 wins and 0 for a tie.
+    double mean = (total.wins[1] - total.wins[2]) / total.weight;
+    double square = (total.wins[1] + total.wins[2]) / total.weight;
+    double spread = (square - mean * mean) * total.weight / (total.weight - 1.0);
+    variance += fairness->strata[s].weight * fairness->strata[s].weight * spread / total.weight;
+    games += (long long)total.weight;
+  }
+
+  printf("Sampled: %lld games in %d strata in %.3f s\n", games, fairness->stratum_count, elapsed);
+  printf("Player 1 wins: %.4f%%\n", 100.0 * wins[1]);
+  printf("Player 2 wins: %.4f%%\n", 100.0 * wins[2]);
+  printf("Ties: %.4f%%\n", 100.0 * wins[0]);
+  printf("Mean score: %.4f : %.4f\n", score[0], score[1]);
+  printf("Mean turns: %.4f\n", turns);
+  printf("First-player advantage: %+.4f percentage points, 95%% confidence interval +-%.4f\n",
+         100.0 * (wins[1] - wins[2]), 100.0 * 1.96 * sqrt(variance));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the usage of the fairness mode.
+/// @return 1, the exit code for invalid arguments.
+static int fairnessUsage(void)
+{
+  printf("Usage: ./a4-csf --fairness [--p1 <strategy>] [--p2 <strategy>] [--threads <count>] [--samples <games>] "
+         "[--seed <seed>] <config file>\n");
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Entry point of the fairness mode started with "--fairness".
+/// Computes the chances of both seats to win on the deck of the configuration file over all deals of
+/// distributeCards with the standard rules, with the strategies given by "--p1" and "--p2" (default random). All
+/// deals are played if the deck has at most MAX_EXACT_DEALS distinct deals, which is exact for deterministic
+/// strategies, see playsDeterministically. Otherwise, or if "--samples <games>" is given, a stratified sample of
+/// that many games (default DEFAULT_SAMPLES) is played. "--seed" seeds the deals of the sample and the decisions of
+/// random strategies, and "--threads" sets the number of workers.
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// @return 0 if the analysis finished; 1 for invalid arguments; 2 or 3 for configuration file errors; 4 if there
+/// is not enough memory.
+int runFairness(int argc, char *argv[])
+{
+  Fairness fairness;
+  memset(&fairness, 0, sizeof(fairness));
+  findStrategy("random", &fairness.seats[0]);
+  findStrategy("random", &fairness.seats[1]);
+  fairness.seed = 1;
+  int worker_count = availableCores();
+  long long samples = 0;
+  const char *config_path = NULL;
+
+  for (int i = 2; i < argc; i++)
+  {
+    if ((strcmp(argv[i], "--p1") == 0 || strcmp(argv[i], "--p2") == 0) && i + 1 < argc)
+    {
+      Seat *seat = &fairness.seats[argv[i][3] - '1'];
+      if (findStrategy(argv[++i], seat) != 0)
+      {
+        return fairnessUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+    {
+      worker_count = atoi(argv[++i]);
+      if (worker_count < 1)
+      {
+        return fairnessUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+    {
+      samples = atoll(argv[++i]);
+      if (samples < 1)
+      {
+        return fairnessUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+    {
+      fairness.seed = strtoull(argv[++i], NULL, 10);
+    }
+    else if (i == argc - 1 && strncmp(argv[i], "--", 2) != 0)
+    {
+      config_path = argv[i];
+    }
+    else
+    {
+      return fairnessUsage();
+    }
+  }
+  if (!config_path)
+  {
+    return fairnessUsage();
+  }
+
+  char invalid_line[CONFIG_LINE_SIZE];
+  int status = loadConfig(config_path, &fairness.deck, invalid_line);
+  if (status != CONFIG_OK)
+  {
+    printConfigError(status, config_path, invalid_line);
+    return configExitCode(status);
+  }
+
+  int size = fairness.deck.size;
+  fairness.dealt = size < 2 * STANDARD_HAND_SIZE ? size : 2 * STANDARD_HAND_SIZE;
+  fairness.hand_sizes[0] = (fairness.dealt + 1) / 2;
+  fairness.hand_sizes[1] = fairness.dealt / 2;
+  for (int i = 0; i < size; i++)
+  {
+    fairness.deck_counts[fairness.deck.kinds[i]]++;
+  }
+  for (int kind = CARD_KINDS - 1; kind >= 0; kind--)
+  {
+    fairness.cards_from[kind] = fairness.cards_from[kind + 1] + fairness.deck_counts[kind];
+  }
+
+  double hand_pairs = 0.0;
+  double deals = samples == 0 && size - fairness.dealt <= MAX_EXACT_PILE ? countDeals(&fairness, &hand_pairs) : 0.0;
+  int exact = deals > 0.0 && deals <= MAX_EXACT_DEALS;
+  fairness.draws = 1;
+  if (exact && deals < DEFAULT_SAMPLES &&
+      (!playsDeterministically(&fairness.seats[0]) || !playsDeterministically(&fairness.seats[1])))
+  {
+    fairness.draws = (int)ceil(DEFAULT_SAMPLES / deals);
+  }
+  status = exact ? prepareExact(&fairness) : prepareSample(&fairness, samples ? samples : DEFAULT_SAMPLES);
+
+  fairness.job_totals = status == 0 ? calloc(fairness.job_count, sizeof(FairnessTotals)) : NULL;
+  fairness.worker_decks = fairness.job_totals ? calloc(worker_count, sizeof(uint8_t *)) : NULL;
+  int ready = fairness.worker_decks != NULL;
+  for (int w = 0; ready && w < worker_count; w++)
+  {
+    fairness.worker_decks[w] = malloc(2 * size);
+    ready = fairness.worker_decks[w] != NULL;
+  }
+
+  double start = currentSeconds();
+  if (!ready || runJobs(fairness.job_count, worker_count, runFairnessJob, &fairness) != 0)
+  {
+    printf("Error: Out of memory\n");
+    freeFairness(&fairness, worker_count);
+    return 4;
+  }
+  double elapsed = currentSeconds() - start;
+
+  printf("Fairness of %s: %d cards, %s as player 1, %s as player 2, %d threads\n", config_path, size,
+         fairness.seats[0].name, fairness.seats[1].name, worker_count);
+  if (exact)
+  {
+    printExact(&fairness, hand_pairs, elapsed);
+  }
+  else
+  {
+    printSample(&fairness, elapsed);
+  }
+  freeFairness(&fairness, worker_count);
+  return 0;
+}
@@ -0,0 +1,18 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Seat fairness analysis of the decks of "Entertaining Spice Pretending".
+//
+// Computes how often player 1 and player 2 win on a deck over all deals of distributeCards, with fixed strategies
+// for both seats, either exactly or from a stratified sample for decks with too many deals.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef FAIRNESS_H
+#define FAIRNESS_H
+
+int runFairness(int argc, char *argv[]);
+
+#endif
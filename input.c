@@ -0,0 +1,169 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Command input of the interactive game of "Entertaining Spice Pretending".
+//
+// The reader refills its buffer with a single read call once it has been consumed, and flushes stdout first so a
+// prompt is visible before the game waits for a human player. Commands are looked up case-insensitively in a table.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "input.h"
+
+typedef struct CommandName
+{
+  const char *name;
+  Command command;
+} CommandName;
+
+static const CommandName COMMANDS[] = {
+  {"play", COMMAND_PLAY},
+  {"challenge", COMMAND_CHALLENGE},
+  {"quit", COMMAND_QUIT},
+  {"draw", COMMAND_DRAW},
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Sets up a reader for a file descriptor.
+/// @param reader A pointer to the reader.
+/// @param fd The file descriptor to read from, usually STDIN_FILENO.
+void initCommandReader(CommandReader *reader, int fd)
+{
+  reader->fd = fd;
+  reader->position = 0;
+  reader->length = 0;
+  reader->at_end = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Makes sure that the buffer of a reader holds unread input.
+/// @param reader A pointer to the reader.
+/// @return 1 if there is input to read; 0 at the end of the input or on a read error.
+static int hasInput(CommandReader *reader)
+{
+  if (reader->position < reader->length)
+  {
+    return 1;
+  }
+  if (reader->at_end)
+  {
+    return 0;
+  }
+
+  fflush(stdout);
+  ssize_t count;
+  do
+  {
+    count = read(reader->fd, reader->buffer, COMMAND_BUFFER_SIZE);
+  } while (count < 0 && errno == EINTR);
+
+  reader->position = 0;
+  reader->length = count > 0 ? (size_t)count : 0;
+  reader->at_end = count <= 0;
+  return count > 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads the next whitespace separated token, skipping any whitespace including line ends before it.
+/// @param reader A pointer to the reader.
+/// @param token The buffer of TOKEN_SIZE characters receiving the token. Longer tokens are consumed completely and
+/// cut off.
+/// @return 0 if a token was read; EOF if the input ended before a token.
+int readToken(CommandReader *reader, char *token)
+{
+  while (hasInput(reader) && isspace(reader->buffer[reader->position]))
+  {
+    reader->position++;
+  }
+  if (!hasInput(reader))
+  {
+    return EOF;
+  }
+
+  size_t length = 0;
+  while (hasInput(reader) && !isspace(reader->buffer[reader->position]))
+  {
+    if (length < TOKEN_SIZE - 1)
+    {
+      token[length++] = (char)reader->buffer[reader->position];
+    }
+    reader->position++;
+  }
+  token[length] = '\0';
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Discards the rest of the current line including its line end.
+/// @param reader A pointer to the reader.
+void skipLine(CommandReader *reader)
+{
+  while (hasInput(reader))
+  {
+    if (reader->buffer[reader->position++] == '\n')
+    {
+      return;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Looks up a command by its name, ignoring the case.
+/// @param token The name.
+/// @return The command, or COMMAND_UNKNOWN.
+Command findCommand(const char *token)
+{
+  for (size_t i = 0; i < sizeof(COMMANDS) / sizeof(COMMANDS[0]); i++)
+  {
+    if (strcasecmp(token, COMMANDS[i].name) == 0)
+    {
+      return COMMANDS[i].command;
+    }
+  }
+  return COMMAND_UNKNOWN;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Parses a card token of the form <value>_<spice> like sscanf("%d_%c") did: the value may have a sign, and
+/// anything after the spice character is ignored.
+/// @param token The token.
+/// @param value A pointer to the variable receiving the value.
+/// @param spice A pointer to the variable receiving the spice character.
+/// @return 0 if the token is a card; 1 otherwise.
+int parseCard(const char *token, int *value, char *spice)
+{
+  const char *digit = token;
+  int negative = *digit == '-';
+  if (*digit == '-' || *digit == '+')
+  {
+    digit++;
+  }
+  if (!isdigit((unsigned char)*digit))
+  {
+    return 1;
+  }
+
+  unsigned number = 0;
+  for (; isdigit((unsigned char)*digit); digit++)
+  {
+    number = number * 10 + (unsigned)(*digit - '0');
+  }
+  if (digit[0] != '_' || digit[1] == '\0')
+  {
+    return 1;
+  }
+
+  *value = (int)(negative ? 0u - number : number);
+  *spice = digit[1];
+  return 0;
+}
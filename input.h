@@ -0,0 +1,46 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Command input of the interactive game of "Entertaining Spice Pretending".
+//
+// Standard input is read in large blocks and split into whitespace separated tokens in one pass over the buffer,
+// which replaces one scanf call per token. Tokens are read exactly like scanf("%s") read them, including across line
+// ends, so scripted sessions behave as before.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+
+#define COMMAND_BUFFER_SIZE 65536
+#define TOKEN_SIZE 32
+
+typedef enum Command
+{
+  COMMAND_PLAY,
+  COMMAND_CHALLENGE,
+  COMMAND_QUIT,
+  COMMAND_DRAW,
+  COMMAND_UNKNOWN
+} Command;
+
+typedef struct CommandReader
+{
+  int fd;
+  size_t position;
+  size_t length;
+  int at_end;
+  unsigned char buffer[COMMAND_BUFFER_SIZE];
+} CommandReader;
+
+void initCommandReader(CommandReader *reader, int fd);
+int readToken(CommandReader *reader, char *token);
+void skipLine(CommandReader *reader);
+Command findCommand(const char *token);
+int parseCard(const char *token, int *value, char *spice);
+
+#endif
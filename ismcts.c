@@ -0,0 +1,544 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Information-set Monte Carlo tree search player of "Entertaining Spice Pretending".
+//
+// Moves are numbered so that a tree node can store them in 16 bits: drawing, the two challenges, and for every card
+// kind in the hand a truthful play and three lies (wrong value, wrong spice, both wrong). The claimed card of a lie
+// only matters through which of its properties differ from the real card, so one claim per kind of lie is enough.
+// Determinizations are dealt into a GameState and played out with applyMove, so a playout never allocates.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "ismcts.h"
+#include "pool.h"
+
+#define MOVE_DRAW 0
+#define MOVE_CHALLENGE_VALUE 1
+#define MOVE_CHALLENGE_SPICE 2
+#define MOVE_PLAY 3
+#define MOVE_COUNT (MOVE_PLAY + 4 * CARD_KINDS)
+
+#define LIE_VALUE 1
+#define LIE_SPICE 2
+
+// Percentage of determinizations in which the opponent's face-down card is the card the opponent claimed.
+#define CLAIM_BELIEF 70
+
+// Score difference at which a playout is worth 0.75 to the leading player. Rewarding the difference instead of
+// only the winner keeps the playouts of a long game from drowning the effect of a single move.
+#define MARGIN_SCALE 10.0
+
+// Exploration constant of the UCB1 selection.
+#define EXPLORATION 0.7
+
+// Number of tree nodes of a search with a time budget. Once the nodes are used up the tree stops growing and the
+// remaining iterations only refine the statistics of the existing nodes.
+#define TIMED_NODES 65536
+
+const IsmctsConfig ISMCTS_DEFAULTS = {1000, 0.0, 1};
+
+typedef struct Node
+{
+  int parent;
+  int child;
+  int sibling;
+  int visits;
+  int available;
+  double reward;
+  int16_t move;
+  int8_t mover;
+} Node;
+
+typedef struct SearchThread
+{
+  uint64_t rng;
+  int iterations;
+  int visits[MOVE_COUNT];
+} SearchThread;
+
+typedef struct Search
+{
+  const TurnView *view;
+  const IsmctsConfig *config;
+  int seat;
+  uint8_t *pool;
+  int pool_size;
+  int opponent_hand;
+  int opponent_card;
+  int claimed_index;
+  int draw_size;
+  double deadline;
+  SearchThread *threads;
+} Search;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Turns a move number into an action.
+/// @param move The move number.
+/// @param action A pointer to the action to fill in.
+static void moveAction(int move, Action *action)
+{
+  if (move == MOVE_DRAW)
+  {
+    action->type = ACTION_DRAW;
+    return;
+  }
+  if (move < MOVE_PLAY)
+  {
+    action->type = ACTION_CHALLENGE;
+    action->challenge_value = move == MOVE_CHALLENGE_VALUE;
+    return;
+  }
+
+  int index = (move - MOVE_PLAY) / 4;
+  int lie = (move - MOVE_PLAY) % 4;
+  action->type = ACTION_PLAY;
+  action->hand_value = cardValue(index);
+  action->hand_spice = cardSpice(index);
+  action->claimed_value = lie & LIE_VALUE ? cardValue(index) % CARD_VALUES + 1 : cardValue(index);
+  action->claimed_spice = lie & LIE_SPICE ? cardSpice((index + CARD_VALUES) % CARD_KINDS) : cardSpice(index);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Finds the kind of the card a play claims.
+/// @param index The kind index of the played card.
+/// @param lie The lie bits of the play.
+/// @return The kind index of the claimed card, as moveAction claims it.
+static int claimedKind(int index, int lie)
+{
+  int value = lie & LIE_VALUE ? cardValue(index) % CARD_VALUES : cardValue(index) - 1;
+  int spice = lie & LIE_SPICE ? (index / CARD_VALUES + 1) % (CARD_KINDS / CARD_VALUES) : index / CARD_VALUES;
+  return spice * CARD_VALUES + value;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Turns a play the searching player observes, a claim of the opponent, into an action of the opponent. The
+/// opponent plays the claimed card if it holds one and otherwise one of the cards it can lie about, at random.
+/// @param hand A pointer to the opponent's hand in the determinization.
+/// @param move The move number MOVE_PLAY + 4 * claimed kind.
+/// @param action A pointer to the action to fill in.
+/// @param rng A pointer to the random generator.
+static void claimAction(const Hand *hand, int move, Action *action, uint64_t *rng)
+{
+  int claimed = (move - MOVE_PLAY) / 4;
+  if (hand->counts[claimed] > 0)
+  {
+    moveAction(MOVE_PLAY + 4 * claimed, action);
+    return;
+  }
+
+  // Every kind of lie leads to the claim from exactly one kind, so there are at most three candidates.
+  int candidates[3];
+  int count = 0;
+  for (int index = handFirst(hand); index >= 0; index = handNext(hand, index))
+  {
+    for (int lie = 1; lie < 4; lie++)
+    {
+      if (claimedKind(index, lie) == claimed)
+      {
+        candidates[count++] = MOVE_PLAY + 4 * index + lie;
+      }
+    }
+  }
+  moveAction(candidates[randomBelow(rng, count)], action);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Lists the moves of the player to move. The plays of the searching player are its real plays. The plays of the
+/// opponent are listed by what the searching player sees of them, the claimed card, so that the tree does not tell
+/// the searching player which card the opponent played or whether it lied.
+/// @param state A pointer to the game state.
+/// @param observed 1 if the opponent of the searching player is to move.
+/// @param moves An array of at least MOVE_COUNT entries receiving the move numbers.
+/// @return The number of moves.
+static int legalMoves(const GameState *state, int observed, int16_t *moves)
+{
+  int count = 0;
+  moves[count++] = MOVE_DRAW;
+  if (state->players[1 - state->seat].has_played)
+  {
+    moves[count++] = MOVE_CHALLENGE_VALUE;
+    moves[count++] = MOVE_CHALLENGE_SPICE;
+  }
+
+  const Hand *hand = &state->players[state->seat].hand;
+  uint32_t claims = 0;
+  for (int index = handFirst(hand); index >= 0; index = handNext(hand, index))
+  {
+    for (int lie = 0; lie < 4; lie++)
+    {
+      if (!observed)
+        moves[count++] = (int16_t)(MOVE_PLAY + 4 * index + lie);
+      else
+        claims |= 1u << claimedKind(index, lie);
+    }
+  }
+  for (; claims; claims &= claims - 1)
+  {
+    moves[count++] = (int16_t)(MOVE_PLAY + 4 * __builtin_ctz(claims));
+  }
+  return count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Deals a determinization of the hidden cards of the searching player's view. Both players keep their seats, so
+/// that the game ends before the turn of player 1 as in the real game. The opponent's face-down card is believed to be
+/// the claimed card CLAIM_BELIEF percent of the time, since a card drawn uniformly from the pool would make every
+/// claim look like a lie.
+/// @param search A pointer to the search.
+/// @param state A pointer to the state to deal.
+/// @param pool A buffer of search->pool_size card kinds, shuffled partially. The draw pile of the state points into it.
+/// @param rng A pointer to the random generator.
+static void determinize(const Search *search, GameState *state, uint8_t *pool, uint64_t *rng)
+{
+  const TurnView *view = search->view;
+  Player *opponent = &state->players[1 - search->seat];
+  state->players[search->seat] = *view->self;
+  *opponent = *view->opponent;
+  state->rules = NULL;
+
+  int first = 0;
+  if (search->opponent_card)
+  {
+    int position = -1;
+    if (search->claimed_index >= 0 && randomBelow(rng, 100) < CLAIM_BELIEF)
+    {
+      for (int i = 0; i < search->pool_size && position < 0; i++)
+      {
+        position = pool[i] == search->claimed_index ? i : -1;
+      }
+    }
+    if (position < 0)
+    {
+      position = randomBelow(rng, search->pool_size);
+    }
+
+    uint8_t card = pool[position];
+    pool[position] = pool[0];
+    pool[0] = card;
+    opponent->latest_card.value = cardValue(card);
+    opponent->latest_card.spice = cardSpice(card);
+    first = 1;
+  }
+
+  int needed = first + search->opponent_hand + search->draw_size;
+  for (int i = first; i < needed; i++)
+  {
+    int j = i + randomBelow(rng, search->pool_size - i);
+    uint8_t temp = pool[i];
+    pool[i] = pool[j];
+    pool[j] = temp;
+  }
+
+  Hand *hand = &opponent->hand;
+  memset(hand, 0, sizeof(Hand));
+  for (int i = first; i < first + search->opponent_hand; i++)
+  {
+    handAdd(hand, pool[i]);
+  }
+
+  state->draw_pile.kinds = pool + first + search->opponent_hand;
+  state->draw_pile.top = 0;
+  state->draw_pile.size = search->draw_size;
+  state->cards_played_this_round = view->cards_played_this_round;
+  state->latest_card_number = view->latest_card_number;
+  state->latest_card_spice = view->latest_card_spice;
+  state->seat = search->seat;
+  state->game_over = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays a game to its end with random moves, playing truthfully about half of the time.
+/// @param state A pointer to the game state.
+/// @param rng A pointer to the random generator.
+static void rollout(GameState *state, uint64_t *rng)
+{
+  while (!gameStateOver(state))
+  {
+    const Hand *hand = &state->players[state->seat].hand;
+    int roll = randomBelow(rng, 100);
+    int move = MOVE_DRAW;
+
+    if (state->players[1 - state->seat].has_played && roll < 25)
+    {
+      move = MOVE_CHALLENGE_VALUE + randomBelow(rng, 2);
+    }
+    else if (!handIsEmpty(hand) && roll < 85)
+    {
+      int index = handFirst(hand);
+      for (int skip = randomBelow(rng, hand->size); skip >= hand->counts[index]; index = handNext(hand, index))
+      {
+        skip -= hand->counts[index];
+      }
+      int claim = 0;
+      if (!randomBelow(rng, 2))
+        claim = 1 + randomBelow(rng, 3);
+      move = MOVE_PLAY + 4 * index + claim;
+    }
+
+    Action action;
+    MoveUndo undo;
+    moveAction(move, &action);
+    applyMove(state, &action, &undo);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Runs the iterations of one search thread on its own tree and stores the visits of the root moves.
+/// @param job The index of the thread.
+/// @param worker Unused.
+/// @param context A pointer to the search.
+static void searchTree(int job, int worker, void *context)
+{
+  (void)worker;
+  Search *search = context;
+  SearchThread *thread = &search->threads[job];
+  int timed = search->config->seconds > 0;
+  int capacity = timed ? TIMED_NODES : thread->iterations + 1;
+
+  Node *nodes = malloc(sizeof(Node) * capacity);
+  uint8_t *pool = malloc(search->pool_size + 1);
+  if (!nodes || !pool)
+  {
+    free(nodes);
+    free(pool);
+    return;
+  }
+  memcpy(pool, search->pool, search->pool_size);
+
+  nodes[0] = (Node){-1, -1, -1, 0, 0, 0.0, -1, -1};
+  int node_count = 1;
+
+  for (int iteration = 0; timed ? (iteration & 63) != 0 || currentSeconds() < search->deadline
+                                : iteration < thread->iterations; iteration++)
+  {
+    GameState state;
+    determinize(search, &state, pool, &thread->rng);
+
+    int node = 0;
+    while (!gameStateOver(&state))
+    {
+      int16_t moves[MOVE_COUNT];
+      int move_count = legalMoves(&state, state.seat != search->seat, moves);
+      uint64_t legal[2] = {0, 0};
+      uint64_t tried[2] = {0, 0};
+      for (int i = 0; i < move_count; i++)
+      {
+        legal[moves[i] >> 6] |= 1ull << (moves[i] & 63);
+      }
+
+      int best = -1;
+      double best_score = -1.0;
+      for (int child = nodes[node].child; child >= 0; child = nodes[child].sibling)
+      {
+        int move = nodes[child].move;
+        if (!(legal[move >> 6] >> (move & 63) & 1))
+        {
+          continue;
+        }
+        tried[move >> 6] |= 1ull << (move & 63);
+        Node *candidate = &nodes[child];
+        candidate->available++;
+        double score = candidate->reward / candidate->visits +
+                       EXPLORATION * sqrt(log((double)candidate->available) / candidate->visits);
+        if (score > best_score)
+        {
+          best_score = score;
+          best = child;
+        }
+      }
+
+      int untried = move_count - __builtin_popcountll(tried[0]) - __builtin_popcountll(tried[1]);
+      int expand = untried > 0 && node_count < capacity;
+      if (!expand && best < 0)
+      {
+        break;
+      }
+
+      if (expand)
+      {
+        int skip = randomBelow(&thread->rng, untried);
+        int move = 0;
+        for (int i = 0; i < move_count; i++)
+        {
+          if (!(tried[moves[i] >> 6] >> (moves[i] & 63) & 1) && skip-- == 0)
+          {
+            move = moves[i];
+            break;
+          }
+        }
+        best = node_count++;
+        nodes[best] = (Node){node, -1, nodes[node].child, 0, 1, 0.0, (int16_t)move, (int8_t)state.seat};
+        nodes[node].child = best;
+      }
+
+      Action action;
+      MoveUndo undo;
+      if (state.seat != search->seat && nodes[best].move >= MOVE_PLAY)
+        claimAction(&state.players[state.seat].hand, nodes[best].move, &action, &thread->rng);
+      else
+        moveAction(nodes[best].move, &action);
+      applyMove(&state, &action, &undo);
+      node = best;
+
+      if (expand)
+      {
+        break;
+      }
+    }
+
+    rollout(&state, &thread->rng);
+    int my_score = state.players[search->seat].score;
+    int other_score = state.players[1 - search->seat].score;
+    double margin = my_score - other_score;
+    double reward = 0.5 + 0.5 * margin / (fabs(margin) + MARGIN_SCALE);
+
+    for (; node >= 0; node = nodes[node].parent)
+    {
+      nodes[node].visits++;
+      nodes[node].reward += nodes[node].mover == search->seat ? reward : 1.0 - reward;
+    }
+  }
+
+  for (int child = nodes[0].child; child >= 0; child = nodes[child].sibling)
+  {
+    thread->visits[nodes[child].move] += nodes[child].visits;
+  }
+
+  free(nodes);
+  free(pool);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Strategy choosing the move that information-set Monte Carlo tree search visits most often.
+/// The search needs view->tracker to know which cards can be hidden; without it the strategy draws.
+/// @param view The state of the game visible to the player.
+/// @param action A pointer to the action to fill in.
+/// @param context A pointer to the IsmctsConfig with the search budget.
+void strategyIsmcts(const TurnView *view, Action *action, void *context)
+{
+  const IsmctsConfig *config = context;
+  int thread_count = config->threads > 0 ? config->threads : 1;
+  int needed = view->opponent->hand.size + view->opponent->has_played + pileCount(view->draw_pile);
+  int pool_capacity = view->tracker && (int)view->tracker->total > needed ? (int)view->tracker->total : needed;
+  Search *search = malloc(sizeof(Search));
+  SearchThread *threads = calloc(thread_count, sizeof(SearchThread));
+  uint8_t *pool = malloc(pool_capacity + 1);
+  if (!search || !threads || !pool || !view->tracker)
+  {
+    free(search);
+    free(threads);
+    free(pool);
+    action->type = ACTION_DRAW;
+    return;
+  }
+
+  search->view = view;
+  search->config = config;
+  search->seat = view->seat;
+  search->pool = pool;
+  search->threads = threads;
+  search->opponent_hand = view->opponent->hand.size;
+  search->opponent_card = view->opponent->has_played;
+  search->claimed_index = cardIndex(view->opponent->claimed_card.value, view->opponent->claimed_card.spice);
+  search->draw_size = pileCount(view->draw_pile);
+
+  // Every card the player has not seen can be hidden in the opponent's hand, the opponent's face-down card or the
+  // draw pile. Cards the player held, drew or saw revealed are known to be elsewhere, even once they were played.
+  // The pool holds all of them, however large the deck.
+  search->pool_size = 0;
+  for (int index = 0; index < CARD_KINDS; index++)
+  {
+    for (uint32_t count = view->tracker->unseen[index]; count > 0; count--)
+    {
+      pool[search->pool_size++] = (uint8_t)index;
+    }
+  }
+  // Only happens if the tracker does not belong to the dealt deck; fill the pool up with arbitrary kinds.
+  for (; search->pool_size < needed; search->pool_size++)
+  {
+    pool[search->pool_size] = (uint8_t)randomBelow(view->rng, CARD_KINDS);
+  }
+
+  search->deadline = currentSeconds() + config->seconds;
+  for (int i = 0; i < thread_count; i++)
+  {
+    threads[i].rng = nextRandom(view->rng);
+    threads[i].iterations = config->iterations / thread_count + (i < config->iterations % thread_count);
+  }
+  runJobs(thread_count, thread_count, searchTree, search);
+
+  int best_move = MOVE_DRAW;
+  int best_visits = -1;
+  for (int move = 0; move < MOVE_COUNT; move++)
+  {
+    int visits = 0;
+    for (int i = 0; i < thread_count; i++)
+    {
+      visits += threads[i].visits[move];
+    }
+    if (visits > best_visits)
+    {
+      best_visits = visits;
+      best_move = move;
+    }
+  }
+
+  free(threads);
+  free(pool);
+  free(search);
+  moveAction(best_move, action);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Parses one of the options "--iterations <count>", "--think <milliseconds>" and "--search-threads <count>".
+/// @param argv An array of strings representing the command-line arguments.
+/// @param index A pointer to the index of the option, advanced past its value if it is parsed.
+/// @param end The index of the first argument that is not an option.
+/// @param config A pointer to the search budget to change.
+/// @return 0 if the option was parsed; 1 if it is not a search option or its value is invalid.
+int parseSearchOption(char *argv[], int *index, int end, IsmctsConfig *config)
+{
+  if (*index + 1 >= end)
+  {
+    return 1;
+  }
+
+  char *rest = NULL;
+  long number = strtol(argv[*index + 1], &rest, 10);
+  if (*rest != '\0' || number < 1 || number > INT32_MAX)
+  {
+    return 1;
+  }
+
+  if (strcmp(argv[*index], "--iterations") == 0)
+    config->iterations = (int)number;
+  else if (strcmp(argv[*index], "--think") == 0)
+    config->seconds = number / 1000.0;
+  else if (strcmp(argv[*index], "--search-threads") == 0)
+    config->threads = (int)number;
+  else
+    return 1;
+
+  (*index)++;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Gives a seat playing the search strategy the given budget instead of ISMCTS_DEFAULTS.
+/// @param seat A pointer to the seat.
+/// @param config A pointer to the search budget, which has to outlive the seat.
+void useSearchConfig(Seat *seat, IsmctsConfig *config)
+{
+  if (seat->decide == strategyIsmcts)
+  {
+    seat->context = config;
+  }
+}
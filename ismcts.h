@@ -0,0 +1,37 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Information-set Monte Carlo tree search player of "Entertaining Spice Pretending".
+//
+// The player searches one tree over the moves of both seats, starting from the seat it actually plays. Every
+// iteration deals a new determinization of the hidden cards (the opponent's hand, the opponent's face-down card and
+// the draw pile) from the cards the player has not seen, and only the moves that are legal in that determinization
+// are considered on the way down. The opponent's plays are keyed by the card they claim, not by the card they put
+// face down, so the tree does not learn from cards the player could not see.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef ISMCTS_H
+#define ISMCTS_H
+
+#include "simulate.h"
+
+// Search budget of the player, passed as the context of its Seat. The search stops after the given number of
+// iterations or, if seconds is greater than 0, after the given thinking time. With more than one thread every
+// thread searches its own tree and the root statistics are merged.
+typedef struct IsmctsConfig
+{
+  int iterations;
+  double seconds;
+  int threads;
+} IsmctsConfig;
+
+extern const IsmctsConfig ISMCTS_DEFAULTS;
+
+void strategyIsmcts(const TurnView *view, Action *action, void *context);
+int parseSearchOption(char *argv[], int *index, int end, IsmctsConfig *config);
+void useSearchConfig(Seat *seat, IsmctsConfig *config);
+
+#endif
@@ -0,0 +1,168 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Work-stealing thread pool for running many independent jobs on all cores.
+//
+// The set of jobs is known before the workers start, so a deque never grows. Its top and bottom index are packed
+// into one atomic word, which lets the owner and the thieves take jobs with a single compare-and-swap each.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "pool.h"
+
+#define CACHE_LINE 64
+
+typedef struct JobDeque
+{
+  _Alignas(CACHE_LINE) _Atomic uint64_t range;
+} JobDeque;
+
+typedef struct Worker
+{
+  pthread_t thread;
+  int index;
+  struct Pool *pool;
+} Worker;
+
+typedef struct Pool
+{
+  JobDeque *deques;
+  int worker_count;
+  JobFunction run;
+  void *context;
+} Pool;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the number of online processor cores.
+/// @return The number of cores, at least 1.
+int availableCores(void)
+{
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 0 ? (int)cores : 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Packs the top and bottom index of a deque into one word.
+/// @param top The index of the next job to steal.
+/// @param bottom The index behind the next job of the owner.
+/// @return The packed range.
+static uint64_t packRange(uint32_t top, uint32_t bottom)
+{
+  return ((uint64_t)top << 32) | bottom;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Takes one job from a deque, either from the bottom as its owner or from the top as a thief.
+/// @param deque A pointer to the deque.
+/// @param steal 1 to take the job from the top; 0 to take it from the bottom.
+/// @return The index of the job, or -1 if the deque is empty.
+static int takeJob(JobDeque *deque, int steal)
+{
+  uint64_t range = atomic_load_explicit(&deque->range, memory_order_relaxed);
+
+  for (;;)
+  {
+    uint32_t top = (uint32_t)(range >> 32);
+    uint32_t bottom = (uint32_t)range;
+    if (top >= bottom)
+    {
+      return -1;
+    }
+
+    uint64_t next = steal ? packRange(top + 1, bottom) : packRange(top, bottom - 1);
+    if (atomic_compare_exchange_weak_explicit(&deque->range, &range, next, memory_order_acq_rel,
+                                              memory_order_relaxed))
+    {
+      return (int)(steal ? top : bottom - 1);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Main loop of a worker thread. Runs the jobs of its own deque and then steals from the other workers,
+/// starting with its right neighbour, until all deques are empty.
+/// @param argument A pointer to the worker.
+/// @return NULL.
+static void *workerMain(void *argument)
+{
+  Worker *worker = argument;
+  Pool *pool = worker->pool;
+  int job;
+
+  while ((job = takeJob(&pool->deques[worker->index], 0)) >= 0)
+  {
+    pool->run(job, worker->index, pool->context);
+  }
+
+  for (int offset = 1; offset < pool->worker_count; offset++)
+  {
+    JobDeque *victim = &pool->deques[(worker->index + offset) % pool->worker_count];
+    while ((job = takeJob(victim, 1)) >= 0)
+    {
+      pool->run(job, worker->index, pool->context);
+    }
+  }
+
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Runs the jobs 0 to job_count - 1 on the given number of worker threads and waits until all of them are done.
+/// Worker i initially owns a contiguous block of jobs, so neighbouring jobs usually run on the same thread.
+/// The calling thread acts as worker 0 and steals the jobs of any worker whose thread could not be started.
+/// @param job_count The number of jobs.
+/// @param worker_count The number of workers, at least 1.
+/// @param run The function executing a job; it receives the job index, the worker index and the context.
+/// @param context A pointer passed through to the job function.
+/// @return 0 if all jobs ran; 1 if the pool could not be created.
+int runJobs(int job_count, int worker_count, JobFunction run, void *context)
+{
+  Pool pool = {NULL, worker_count, run, context};
+  pool.deques = aligned_alloc(CACHE_LINE, sizeof(JobDeque) * worker_count);
+  Worker *workers = malloc(sizeof(Worker) * worker_count);
+  if (!pool.deques || !workers)
+  {
+    free(pool.deques);
+    free(workers);
+    return 1;
+  }
+
+  for (int i = 0; i < worker_count; i++)
+  {
+    uint32_t top = (uint32_t)((long long)job_count * i / worker_count);
+    uint32_t bottom = (uint32_t)((long long)job_count * (i + 1) / worker_count);
+    atomic_init(&pool.deques[i].range, packRange(top, bottom));
+    workers[i].index = i;
+    workers[i].pool = &pool;
+  }
+
+  int started = 1;
+  for (; started < worker_count; started++)
+  {
+    if (pthread_create(&workers[started].thread, NULL, workerMain, &workers[started]) != 0)
+    {
+      break;
+    }
+  }
+
+  workerMain(&workers[0]);
+
+  for (int i = 1; i < started; i++)
+  {
+    pthread_join(workers[i].thread, NULL);
+  }
+
+  free(workers);
+  free(pool.deques);
+  return 0;
+}
@@ -0,0 +1,21 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Work-stealing thread pool for running many independent jobs on all cores.
+//
+// Every worker owns a deque of job indices. A worker takes jobs from the bottom of its own deque and, once that is
+// empty, steals jobs from the top of the other workers' deques, so uneven job lengths are balanced automatically.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef POOL_H
+#define POOL_H
+
+typedef void (*JobFunction)(int job, int worker, void *context);
+
+int availableCores(void);
+int runJobs(int job_count, int worker_count, JobFunction run, void *context);
+
+#endif
@@ -0,0 +1,1023 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Game server of "Entertaining Spice Pretending".
+//
+// All sessions are served by a single thread waiting on one epoll instance. Every game is a turn machine (turn.c)
+// that is stepped once per command, and sockets never block: a session only keeps the game state, the deck it was
+// dealt, the unfinished line of its input and the output the client has not taken yet, so a turn is a few
+// microseconds of work on that memory and thousands of idle sessions cost nothing but their state. While output is
+// pending the session stops reading, so a client that does not read cannot make the server buffer without bound.
+// With a checkpoint file, the games of all sessions are written to it every few seconds while they change and once
+// more when the server stops; a server started with "--resume" keeps those games until their clients come back.
+//
+// Protocol, one line per message. The client sends the commands of the interactive game:
+//   play <hand card> <claimed card> | challenge value | challenge spice | draw | quit
+//   game, asking for the number of the game, and resume <number>, continuing a game of the checkpoint instead
+// The server sends:
+//   turn <own score> <opponent score> <opponent hand size> <cards played this round> <latest claimed card or ->
+//   hand <card> ...
+//   opponent play <claimed card> | opponent draw | opponent challenge <value|spice> <outcome>
+//   challenge <outcome>, where outcome is <successful|failed> <real card> <points> <bonus>
+//   error <message>
+//   game <number>
+//   end <own score> <opponent score> <win|loss|tie>
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "config.h"
+#include "deckgen.h"
+#include "input.h"
+#include "ismcts.h"
+#include "server.h"
+#include "simulate.h"
+#include "stats.h"
+#include "turn.h"
+
+#define SERVER_EVENTS 256
+#define SERVER_READ_SIZE 4096
+#define SESSION_LINE_SIZE 128
+#define SESSION_OUTPUT_SIZE 256
+#define DEFAULT_MAX_SESSIONS 4096
+
+// Descriptors kept free of sessions for the standard streams, the listening socket, the epoll instance, the spare
+// descriptor and the files of checkpoints and scores.
+#define SERVER_RESERVED_FILES 16
+
+// Time between two checkpoints while games change.
+#define CHECKPOINT_INTERVAL_MS 5000
+
+typedef struct Session
+{
+  int fd;
+  int closing;
+  int line_length;
+  int line_too_long;
+  char line[SESSION_LINE_SIZE];
+  char *output;
+  size_t output_length;
+  size_t output_sent;
+  size_t output_capacity;
+  uint64_t id;
+  uint64_t rng;
+  TurnMachine game;
+  struct Session *previous;
+  struct Session *next;
+  uint8_t dealt[];
+} Session;
+
+typedef struct Server
+{
+  int listen_fd;
+  int epoll_fd;
+  int spare_fd;
+  int listening;
+  Deck deck;
+  uint16_t deck_counts[CARD_KINDS];
+  Seat bot;
+  uint64_t seed;
+  Session *sessions;
+  int session_count;
+  int max_sessions;
+  long long games_started;
+  long long games_finished;
+  uint64_t first_id;
+  const char *config_path;
+  const char *checkpoint_path;
+  int changed;
+  uint64_t checkpointed_at;
+  Checkpoint restored;
+  uint8_t *claimed;
+} Server;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Signal handler asking the event loop to stop.
+/// @param signal_number Unused.
+static void requestStop(int signal_number)
+{
+  (void)signal_number;
+  stop_requested = 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Appends formatted text to the output of a session. The text is sent by flushSession.
+/// @param session A pointer to the session.
+/// @param format The printf format string.
+/// @return 0 on success; 1 if there is not enough memory, in which case the session is marked for closing.
+static int sessionPrintf(Session *session, const char *format, ...)
+{
+  va_list arguments;
+  for (;;)
+  {
+    size_t space = session->output_capacity - session->output_length;
+    va_start(arguments, format);
+    int length = vsnprintf(session->output + session->output_length, space, format, arguments);
+    va_end(arguments);
+    if (length < 0)
+    {
+      return 1;
+    }
+    if ((size_t)length < space)
+    {
+      session->output_length += (size_t)length;
+      return 0;
+    }
+
+    size_t capacity = session->output_capacity * 2;
+    while (capacity - session->output_length <= (size_t)length)
+    {
+      capacity *= 2;
+    }
+    char *grown = realloc(session->output, capacity);
+    if (!grown)
+    {
+      session->closing = 1;
+      return 1;
+    }
+    session->output = grown;
+    session->output_capacity = capacity;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Sends the state of the game to the client whose turn it is: the scores, the latest claim and the hand.
+/// @param session A pointer to the session.
+static void sendTurn(Session *session)
+{
+  const GameState *state = &session->game.state;
+  const Player *self = &state->players[0];
+  const Player *opponent = &state->players[1];
+
+  if (opponent->has_played)
+  {
+    sessionPrintf(session, "turn %d %d %d %d %d_%c\n", self->score, opponent->score, opponent->hand.size,
+                  state->cards_played_this_round, state->latest_card_number, state->latest_card_spice);
+  }
+  else
+  {
+    sessionPrintf(session, "turn %d %d %d %d -\n", self->score, opponent->score, opponent->hand.size,
+                  state->cards_played_this_round);
+  }
+
+  sessionPrintf(session, "hand");
+  const Hand *hand = &self->hand;
+  for (int index = handFirst(hand); index >= 0; index = handNext(hand, index))
+  {
+    for (int count = hand->counts[index]; count > 0; count--)
+    {
+      sessionPrintf(session, " %d_%c", cardValue(index), cardSpice(index));
+    }
+  }
+  sessionPrintf(session, "\n");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Sends the outcome of a challenge.
+/// @param session A pointer to the session.
+/// @param result A pointer to the outcome.
+static void sendChallengeResult(Session *session, const ChallengeResult *result)
+{
+  sessionPrintf(session, " %s %d_%c %d %d\n", result->successful ? "successful" : "failed", result->real_value,
+                result->real_spice, result->points, result->bonus);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Turns an action that is allowed in the current state into a command of the turn machine.
+/// @param action A pointer to the action.
+/// @param command A pointer to the command to fill in.
+static void actionCommand(const Action *action, TurnCommand *command)
+{
+  if (action->type == ACTION_PLAY)
+    command->command = COMMAND_PLAY;
+  else if (action->type == ACTION_CHALLENGE)
+    command->command = COMMAND_CHALLENGE;
+  else
+    command->command = COMMAND_DRAW;
+  command->error = TURN_OK;
+  command->has_cards = 1;
+  command->action = *action;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Lets the strategy of the server choose the command of player 2.
+/// Actions that are not allowed are replaced by drawing a card, like in the simulation.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @param command A pointer to the command to fill in.
+static void botCommand(Server *server, Session *session, TurnCommand *command)
+{
+  const GameState *state = &session->game.state;
+  TurnView view = {&state->players[1], &state->players[0], &state->draw_pile, state->cards_played_this_round,
+                   state->latest_card_number, state->latest_card_spice, &session->rng, server->deck_counts,
+                   &session->game.trackers[1], 1};
+  Action action = {ACTION_DRAW, 0, '\0', 0, '\0', 0};
+  STATS_START(decide_started);
+  server->bot.decide(&view, &action, server->bot.context);
+  STATS_STOP(PHASE_DECIDE, decide_started);
+
+  if (!isLegalMove(state, &action))
+  {
+    action.type = ACTION_DRAW;
+  }
+  actionCommand(&action, command);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Sends the final scores once a game is over and marks the session for closing.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+static void finishGame(Server *server, Session *session)
+{
+  int own = session->game.state.players[0].score;
+  int other = session->game.state.players[1].score;
+  sessionPrintf(session, "end %d %d %s\n", own, other, own > other ? "win" : own < other ? "loss" : "tie");
+  session->closing = 1;
+  server->games_finished++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Tells the client what happened in a step of its game. The moves of the client itself are not repeated, and the
+/// server only passes on commands that cannot be rejected.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @param events A pointer to the events of the step.
+static void sendEvents(Server *server, Session *session, const TurnEvents *events)
+{
+  for (int i = 0; i < events->count; i++)
+  {
+    const TurnEvent *event = &events->events[i];
+    int own = event->seat == 0;
+    if (event->type == TURN_TO_MOVE && own)
+    {
+      sendTurn(session);
+    }
+    else if (event->type == TURN_PLAYED && !own)
+    {
+      sessionPrintf(session, "opponent play %d_%c\n", event->claimed_value, event->claimed_spice);
+    }
+    else if (event->type == TURN_DREW && !own)
+    {
+      sessionPrintf(session, "opponent draw\n");
+    }
+    else if (event->type == TURN_CHALLENGED)
+    {
+      if (own)
+        sessionPrintf(session, "challenge");
+      else
+        sessionPrintf(session, "opponent challenge %s", event->challenge_value ? "value" : "spice");
+      sendChallengeResult(session, &event->result);
+    }
+    else if (event->type == TURN_GAME_OVER)
+    {
+      finishGame(server, session);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Executes a command of the client, then lets the strategy of the server move until it is the client's turn again
+/// or the game is over.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @param command A pointer to the command of the client.
+static void playTurns(Server *server, Session *session, const TurnCommand *command)
+{
+  TurnEvents events;
+  TurnExpect expect = stepTurn(&session->game, command, &events);
+  sendEvents(server, session, &events);
+
+  while (expect == EXPECT_COMMAND && session->game.state.seat == 1)
+  {
+    TurnCommand answer;
+    botCommand(server, session, &answer);
+    expect = stepTurn(&session->game, &answer, &events);
+    sendEvents(server, session, &events);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Parses one command line of the client into an action of player 1.
+/// @param line The line without its line end.
+/// @param action A pointer to the action to fill in.
+/// @return NULL if the line is an action; otherwise the error message for the client, or "" for "quit".
+static const char *parseAction(char *line, Action *action)
+{
+  const char *separators = " \t\r";
+  char *save = NULL;
+  char *command = strtok_r(line, separators, &save);
+  char *first = command ? strtok_r(NULL, separators, &save) : NULL;
+  char *second = first ? strtok_r(NULL, separators, &save) : NULL;
+  char *extra = second ? strtok_r(NULL, separators, &save) : NULL;
+
+  switch (command ? findCommand(command) : COMMAND_UNKNOWN)
+  {
+    case COMMAND_PLAY:
+      if (!second || extra)
+      {
+        return "wrong number of parameters";
+      }
+      action->type = ACTION_PLAY;
+      if (parseCard(first, &action->hand_value, &action->hand_spice) != 0 ||
+          parseCard(second, &action->claimed_value, &action->claimed_spice) != 0 ||
+          cardIndex(action->claimed_value, action->claimed_spice) < 0)
+      {
+        return "invalid card format";
+      }
+      return NULL;
+    case COMMAND_CHALLENGE:
+      if (!first || second || (strcasecmp(first, "value") != 0 && strcasecmp(first, "spice") != 0))
+      {
+        return "invalid challenge type";
+      }
+      action->type = ACTION_CHALLENGE;
+      action->challenge_value = strcasecmp(first, "value") == 0;
+      return NULL;
+    case COMMAND_DRAW:
+      action->type = ACTION_DRAW;
+      return first ? "wrong number of parameters" : NULL;
+    case COMMAND_QUIT:
+      return first ? "wrong number of parameters" : "";
+    default:
+      return "unknown command";
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Replaces the game of a session with a game of the checkpoint the server was resumed from, which can be taken
+/// over once.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @param id The number of the game.
+static void resumeSession(Server *server, Session *session, uint64_t id)
+{
+  for (int i = 0; i < server->restored.count; i++)
+  {
+    const CheckpointRecord *record = server->restored.records[i];
+    if (!server->claimed[i] && record->id == id)
+    {
+      server->claimed[i] = 1;
+      restoreGame(record, session->dealt, &session->game);
+      session->id = id;
+      session->rng = record->rng;
+      TurnEvents events;
+      resumeTurns(&session->game, &events);
+      sendEvents(server, session, &events);
+      return;
+    }
+  }
+  sessionPrintf(session, "error unknown game\n");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Executes one command line of the client: its move, the answer of the strategy and the next prompt. Commands that
+/// are malformed or not allowed are answered with an error and leave the client to move.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @param line The line without its line end.
+static void handleLine(Server *server, Session *session, char *line)
+{
+  unsigned long long id = 0;
+  int end = -1;
+  server->changed = 1;
+  if (sscanf(line, " game %n", &end) == 0 && end >= 0 && line[end] == '\0')
+  {
+    sessionPrintf(session, "game %llu\n", (unsigned long long)session->id);
+    return;
+  }
+  if (sscanf(line, " resume %llu %n", &id, &end) == 1 && end >= 0 && line[end] == '\0')
+  {
+    resumeSession(server, session, id);
+    return;
+  }
+
+  Action action = {ACTION_DRAW, 0, '\0', 0, '\0', 0};
+  const char *error = parseAction(line, &action);
+  if (error && !*error)
+  {
+    session->closing = 1;
+    return;
+  }
+  if (!error && !isLegalMove(&session->game.state, &action))
+  {
+    error = action.type == ACTION_PLAY ? "card not in hand" : "opponent has not played";
+  }
+  if (error)
+  {
+    sessionPrintf(session, "error %s\n", error);
+    return;
+  }
+
+  TurnCommand command;
+  actionCommand(&action, &command);
+  playTurns(server, session, &command);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Selects the events a session waits for: output if some is pending, input otherwise.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @param operation EPOLL_CTL_ADD or EPOLL_CTL_MOD.
+/// @return 0 on success; -1 on error.
+static int watchSession(Server *server, Session *session, int operation)
+{
+  struct epoll_event event;
+  event.events = session->output_sent < session->output_length ? EPOLLOUT : EPOLLIN;
+  event.data.ptr = session;
+  return epoll_ctl(server->epoll_fd, operation, session->fd, &event);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Starts or stops waiting for new connections on the listening socket.
+/// @param server A pointer to the server.
+/// @param listening 1 to accept connections; 0 to leave them queued.
+static void watchListener(Server *server, int listening)
+{
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.ptr = NULL;
+  if (epoll_ctl(server->epoll_fd, listening ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, server->listen_fd, &event) == 0)
+  {
+    server->listening = listening;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Closes the connection of a session and frees it. A server that stopped accepting because it ran out of
+/// descriptors starts again.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+static void closeSession(Server *server, Session *session)
+{
+  if (session->previous)
+    session->previous->next = session->next;
+  else
+    server->sessions = session->next;
+  if (session->next)
+    session->next->previous = session->previous;
+
+  close(session->fd);
+  free(session->output);
+  free(session);
+  server->session_count--;
+  server->changed = 1;
+  if (!server->listening)
+  {
+    if (server->spare_fd < 0)
+    {
+      server->spare_fd = open("/dev/null", O_RDONLY);
+    }
+    watchListener(server, 1);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Sends as much of the pending output of a session as the socket takes without blocking.
+/// @param session A pointer to the session.
+/// @return 0 if the connection is still usable; 1 if it failed.
+static int flushSession(Session *session)
+{
+  while (session->output_sent < session->output_length)
+  {
+    ssize_t sent = send(session->fd, session->output + session->output_sent,
+                        session->output_length - session->output_sent, MSG_NOSIGNAL);
+    if (sent < 0)
+    {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : 1;
+    }
+    session->output_sent += (size_t)sent;
+  }
+  session->output_length = 0;
+  session->output_sent = 0;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Reads what a client has sent and executes every complete line. Lines longer than SESSION_LINE_SIZE are answered
+/// with an error once their end arrives.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @return 0 if the connection is still open; 1 if the client closed it or it failed.
+static int readSession(Server *server, Session *session)
+{
+  char buffer[SERVER_READ_SIZE];
+  ssize_t received = recv(session->fd, buffer, sizeof(buffer), 0);
+  if (received <= 0)
+  {
+    return received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+  }
+
+  for (ssize_t i = 0; i < received && !session->closing; i++)
+  {
+    if (buffer[i] != '\n')
+    {
+      if (session->line_length + 1 < SESSION_LINE_SIZE)
+        session->line[session->line_length++] = buffer[i];
+      else
+        session->line_too_long = 1;
+      continue;
+    }
+
+    session->line[session->line_length] = '\0';
+    if (session->line_too_long)
+      sessionPrintf(session, "error line too long\n");
+    else
+      handleLine(server, session, session->line);
+    session->line_length = 0;
+    session->line_too_long = 0;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Handles the events of one session and closes it once its game is over and all output has been sent.
+/// @param server A pointer to the server.
+/// @param session A pointer to the session.
+/// @param events The events reported by epoll.
+static void serveSession(Server *server, Session *session, uint32_t events)
+{
+  int failed = 0;
+  if (events & EPOLLIN)
+  {
+    failed = readSession(server, session);
+  }
+  else if (events & (EPOLLERR | EPOLLHUP))
+  {
+    failed = 1;
+  }
+
+  failed = failed || flushSession(session) != 0;
+  int pending = session->output_sent < session->output_length;
+  if (failed || (session->closing && !pending) || watchSession(server, session, EPOLL_CTL_MOD) != 0)
+  {
+    closeSession(server, session);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Starts a new game for a client that has just connected: shuffles the deck with a seed derived from the seed of
+/// the server and the number of the game, deals it and sends the first prompt. Games of a resumed server are numbered
+/// after the games of its checkpoint, so they are not dealt the decks of the games before.
+/// @param server A pointer to the server.
+/// @param fd The socket of the client, which is closed if the session cannot be started.
+static void startSession(Server *server, int fd)
+{
+  Session *session = malloc(sizeof(Session) + server->deck.size);
+  char *output = malloc(SESSION_OUTPUT_SIZE);
+  if (!session || !output || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+  {
+    free(session);
+    free(output);
+    close(fd);
+    return;
+  }
+
+  memset(session, 0, sizeof(Session));
+  session->fd = fd;
+  session->output = output;
+  session->output_capacity = SESSION_OUTPUT_SIZE;
+  session->id = server->first_id + (uint64_t)server->games_started++;
+  session->rng = deckSeed(server->seed, (long long)session->id);
+
+  memcpy(session->dealt, server->deck.kinds, server->deck.size);
+  shuffleDeck(session->dealt, server->deck.size, &session->rng);
+  TurnEvents events;
+  startTurns(&session->game, session->dealt, server->deck.size, &events);
+
+  session->next = server->sessions;
+  if (server->sessions)
+  {
+    server->sessions->previous = session;
+  }
+  server->sessions = session;
+  server->session_count++;
+  server->changed = 1;
+
+  sendEvents(server, session, &events);
+
+  if (flushSession(session) != 0 || (session->closing && session->output_length == 0) ||
+      watchSession(server, session, EPOLL_CTL_ADD) != 0)
+  {
+    closeSession(server, session);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Tells a client that the server is full and disconnects it.
+/// @param fd The socket of the client.
+static void rejectClient(int fd)
+{
+  static const char FULL[] = "error server full\n";
+  send(fd, FULL, sizeof(FULL) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+  close(fd);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Accepts a pending connection while the process has no descriptor left, by giving up the spare descriptor for it,
+/// and rejects the client. Without a spare descriptor, or if the client cannot be accepted with it either, the server
+/// stops watching the listening socket until a session closes, since the socket would be reported ready again at once.
+/// Linux reports a lack of descriptors before looking for a connection, so this is also how the server finds out that
+/// no client is waiting any more.
+/// @param server A pointer to the server.
+/// @return 1 if a client was rejected; 0 otherwise.
+static int rejectWithSpare(Server *server)
+{
+  int fd = -1;
+  int stuck = 1;
+  if (server->spare_fd >= 0)
+  {
+    close(server->spare_fd);
+    fd = accept(server->listen_fd, NULL, NULL);
+    stuck = fd < 0 && (errno == EMFILE || errno == ENFILE);
+    if (fd >= 0)
+    {
+      rejectClient(fd);
+    }
+    server->spare_fd = open("/dev/null", O_RDONLY);
+  }
+  if (stuck)
+  {
+    watchListener(server, 0);
+  }
+  return fd >= 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Accepts every pending connection. Clients beyond the session limit are told so and disconnected, and so are the
+/// clients that connect while the process has no descriptor left (see rejectWithSpare).
+/// @param server A pointer to the server.
+static void acceptClients(Server *server)
+{
+  for (;;)
+  {
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if (fd < 0 && (errno == EMFILE || errno == ENFILE))
+    {
+      if (rejectWithSpare(server))
+      {
+        continue;
+      }
+      return;
+    }
+    if (fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+      {
+        continue;
+      }
+      return;
+    }
+    if (server->session_count >= server->max_sessions)
+    {
+      rejectClient(fd);
+      continue;
+    }
+    startSession(server, fd);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Creates the listening socket, the epoll instance and the spare descriptor.
+/// @param server A pointer to the server.
+/// @param socket_path The path of the Unix domain socket, which must not exist yet.
+/// @return 0 on success; 1 otherwise.
+static int openServer(Server *server, const char *socket_path)
+{
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(socket_path) >= sizeof(address.sun_path))
+  {
+    return 1;
+  }
+  strcpy(address.sun_path, socket_path);
+
+  server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  server->epoll_fd = epoll_create1(0);
+  if (server->listen_fd < 0 || server->epoll_fd < 0 ||
+      fcntl(server->listen_fd, F_SETFL, fcntl(server->listen_fd, F_GETFL) | O_NONBLOCK) != 0 ||
+      bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+  {
+    return 1;
+  }
+
+  server->spare_fd = open("/dev/null", O_RDONLY);
+  if (listen(server->listen_fd, SOMAXCONN) == 0)
+  {
+    watchListener(server, 1);
+  }
+  if (!server->listening)
+  {
+    unlink(socket_path);
+    return 1;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Raises the limit of open files of the process to what the session limit needs, as far as the hard limit allows,
+/// and lowers the session limit to what fits in the limit of open files otherwise.
+/// @param server A pointer to the server.
+static void fitSessionLimit(Server *server)
+{
+  struct rlimit limit;
+  rlim_t needed = (rlim_t)server->max_sessions + SERVER_RESERVED_FILES;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur >= needed)
+  {
+    return;
+  }
+  limit.rlim_cur = limit.rlim_max == RLIM_INFINITY || limit.rlim_max > needed ? needed : limit.rlim_max;
+  if (setrlimit(RLIMIT_NOFILE, &limit) != 0)
+  {
+    getrlimit(RLIMIT_NOFILE, &limit);
+  }
+  if (limit.rlim_cur < needed)
+  {
+    server->max_sessions = limit.rlim_cur > SERVER_RESERVED_FILES ? (int)(limit.rlim_cur - SERVER_RESERVED_FILES) : 1;
+    printf("Limiting sessions to %d by the limit of open files\n", server->max_sessions);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes the games of all sessions and the games of the resumed checkpoint that no client has taken over yet to
+/// the checkpoint file. The spare descriptor is given up while writing, so the file can be opened even when the
+/// sessions use every other descriptor.
+/// @param server A pointer to the server.
+/// @return The number of games written, or -1 if the checkpoint cannot be written.
+static int checkpointServer(Server *server)
+{
+  server->changed = 0;
+  server->checkpointed_at = statsNow();
+  if (server->spare_fd >= 0)
+  {
+    close(server->spare_fd);
+  }
+  CheckpointWriter *writer = createCheckpoint(server->checkpoint_path, server->config_path);
+  if (!writer)
+  {
+    server->spare_fd = open("/dev/null", O_RDONLY);
+    return -1;
+  }
+
+  for (Session *session = server->sessions; session; session = session->next)
+  {
+    if (!session->closing)
+    {
+      addCheckpointGame(writer, &session->game, server->deck_counts, session->id, session->rng);
+    }
+  }
+  for (int i = 0; i < server->restored.count; i++)
+  {
+    if (!server->claimed[i])
+    {
+      copyCheckpointGame(writer, server->restored.records[i]);
+    }
+  }
+  int count = (int)writer->count;
+  int failed = finishCheckpoint(writer);
+  server->spare_fd = open("/dev/null", O_RDONLY);
+  return failed == 0 ? count : -1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Loads the games of a checkpoint for their clients to take over with "resume". Games dealt from another deck or
+/// waiting for player 2 cannot be continued by the server and are dropped. New games are numbered after the games
+/// of the checkpoint.
+/// @param server A pointer to the server with its deck loaded.
+/// @param path The path of the checkpoint file.
+/// @return CONFIG_OK, or the error of loadCheckpoint.
+static int restoreSessions(Server *server, const char *path)
+{
+  int status = loadCheckpoint(path, &server->restored);
+  if (status != CONFIG_OK)
+  {
+    return status;
+  }
+  server->claimed = calloc((size_t)server->restored.count + 1, 1);
+  if (!server->claimed)
+  {
+    return CONFIG_OUT_OF_MEMORY;
+  }
+
+  int dropped = 0;
+  for (int i = 0; i < server->restored.count; i++)
+  {
+    const CheckpointRecord *record = server->restored.records[i];
+    if (record->seat != 0 || record->pile_count > server->deck.size ||
+        memcmp(record->deck_counts, server->deck_counts, sizeof(server->deck_counts)) != 0)
+    {
+      server->claimed[i] = 1;
+      dropped++;
+    }
+    if (record->id >= server->first_id)
+    {
+      server->first_id = record->id + 1;
+    }
+  }
+  printf("Restored %d games from %s\n", server->restored.count - dropped, path);
+  if (dropped)
+  {
+    printf("Dropped %d games of another deck or waiting for player 2\n", dropped);
+  }
+  return CONFIG_OK;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the usage of the server mode.
+/// @return 1, the exit code for invalid arguments.
+static int serverUsage(void)
+{
+  printf("Usage: ./a4-csf --serve <socket> [--p2 <strategy>] [--seed <seed>] [--max-sessions <count>] [--stats] "
+         "[--checkpoint <file>] [--resume <file>] [--iterations <count>] [--think <ms>] [--search-threads <count>] "
+         "<config file>\n");
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Entry point of the server mode started with "--serve".
+/// Listens on a Unix domain socket and plays one game on the deck of the configuration file with every client that
+/// connects, until the process receives SIGINT or SIGTERM. The deck is shuffled before every game.
+/// "--checkpoint <file>" keeps the games of all sessions in a checkpoint file, and "--resume <file>" loads the games
+/// of a checkpoint file for their clients to continue with "resume <number>".
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// @return 0 if the server was stopped; 1 for invalid arguments; 2 or 3 for configuration file or socket errors;
+/// 4 if there is not enough memory.
+int runServer(int argc, char *argv[])
+{
+  if (argc < 4)
+  {
+    return serverUsage();
+  }
+
+  Server server;
+  memset(&server, 0, sizeof(server));
+  server.listen_fd = -1;
+  server.epoll_fd = -1;
+  server.spare_fd = -1;
+  server.seed = 1;
+  server.max_sessions = DEFAULT_MAX_SESSIONS;
+  findStrategy("random", &server.bot);
+  IsmctsConfig search = ISMCTS_DEFAULTS;
+  const char *socket_path = argv[2];
+  const char *resume_path = NULL;
+
+  int i = 3;
+  for (; i + 1 < argc; i++)
+  {
+    if (strcmp(argv[i], "--stats") == 0)
+    {
+      enableStats();
+    }
+    else if (strcmp(argv[i], "--p2") == 0)
+    {
+      if (findStrategy(argv[++i], &server.bot) != 0)
+      {
+        return serverUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--seed") == 0)
+    {
+      server.seed = strtoull(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "--checkpoint") == 0)
+    {
+      server.checkpoint_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--resume") == 0)
+    {
+      resume_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--max-sessions") == 0)
+    {
+      server.max_sessions = atoi(argv[++i]);
+      if (server.max_sessions < 1)
+      {
+        return serverUsage();
+      }
+    }
+    else if (parseSearchOption(argv, &i, argc - 1, &search) != 0)
+    {
+      return serverUsage();
+    }
+  }
+  if (i != argc - 1)
+  {
+    return serverUsage();
+  }
+  useSearchConfig(&server.bot, &search);
+  fitSessionLimit(&server);
+
+  char invalid_line[CONFIG_LINE_SIZE];
+  int status = loadConfig(argv[i], &server.deck, invalid_line);
+  if (status != CONFIG_OK)
+  {
+    printConfigError(status, argv[i], invalid_line);
+    return configExitCode(status);
+  }
+  for (int card = 0; card < server.deck.size; card++)
+  {
+    server.deck_counts[server.deck.kinds[card]]++;
+  }
+  server.config_path = argv[i];
+
+  int result = 0;
+  status = resume_path ? restoreSessions(&server, resume_path) : CONFIG_OK;
+  if (status != CONFIG_OK)
+  {
+    printConfigError(status, resume_path, NULL);
+    result = configExitCode(status);
+  }
+  else if (openServer(&server, socket_path) != 0)
+  {
+    printf("Error: Cannot open socket: %s\n", socket_path);
+    result = 2;
+  }
+  else
+  {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Serving %s on %s with %s as player 2\n", argv[i], socket_path, server.bot.name);
+    fflush(stdout);
+
+    struct epoll_event events[SERVER_EVENTS];
+    server.checkpointed_at = statsNow();
+    while (!stop_requested)
+    {
+      int ready = epoll_wait(server.epoll_fd, events, SERVER_EVENTS,
+                             server.checkpoint_path ? CHECKPOINT_INTERVAL_MS : -1);
+      for (int e = 0; e < ready; e++)
+      {
+        if (events[e].data.ptr)
+          serveSession(&server, events[e].data.ptr, events[e].events);
+        else
+          acceptClients(&server);
+      }
+      if (ready < 0 && errno != EINTR)
+      {
+        printf("Error: Cannot wait for clients\n");
+        result = 2;
+        break;
+      }
+      statsFlush();
+      if (server.checkpoint_path && server.changed &&
+          statsNow() - server.checkpointed_at >= CHECKPOINT_INTERVAL_MS * 1000000ull &&
+          checkpointServer(&server) < 0)
+      {
+        printf("Error: Cannot write file: %s\n", server.checkpoint_path);
+        fflush(stdout);
+      }
+    }
+
+    unlink(socket_path);
+    printf("Served %lld games, %lld played to the end\n", server.games_started, server.games_finished);
+    if (server.checkpoint_path)
+    {
+      int saved = checkpointServer(&server);
+      if (saved < 0)
+        printf("Error: Cannot write file: %s\n", server.checkpoint_path);
+      else
+        printf("Checkpointed %d games to %s\n", saved, server.checkpoint_path);
+    }
+    printStats();
+  }
+
+  while (server.sessions)
+  {
+    closeSession(&server, server.sessions);
+  }
+  if (server.listen_fd >= 0)
+    close(server.listen_fd);
+  if (server.epoll_fd >= 0)
+    close(server.epoll_fd);
+  if (server.spare_fd >= 0)
+    close(server.spare_fd);
+  closeCheckpoint(&server.restored);
+  free(server.claimed);
+  free(server.deck.kinds);
+  return result;
+}
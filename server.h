@@ -0,0 +1,18 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Game server of "Entertaining Spice Pretending".
+//
+// One process hosts any number of games at the same time, one per client connected to a Unix domain socket. Each
+// client plays player 1 with the text commands of the interactive game against a built-in strategy as player 2.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef SERVER_H
+#define SERVER_H
+
+int runServer(int argc, char *argv[]);
+
+#endif
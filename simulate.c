@@ -0,0 +1,607 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Headless batch simulation of "Entertaining Spice Pretending".
+//
+// Games are played by strategy callbacks on top of the rule functions in engine.c. The game loop mirrors
+// roundWithChallenges and playerTurn from a4.c without any input or narration, and only the final statistics
+// of the whole batch are printed.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "deckgen.h"
+#include "endgame.h"
+#include "eventlog.h"
+#include "ismcts.h"
+#include "simulate.h"
+#include "stats.h"
+
+// The statistics of the games are merged into the totals after every STATS_FLUSH_GAMES games, a power of two.
+#define STATS_FLUSH_GAMES 1024
+
+static const char SPICES[] = {'c', 'p', 'w'};
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays the given hand card and claims it to be the given card.
+/// @param action A pointer to the action to fill in.
+/// @param index The kind index of the card to take from the hand.
+/// @param claimed_value The claimed value.
+/// @param claimed_spice The claimed spice.
+static void playAction(Action *action, int index, int claimed_value, char claimed_spice)
+{
+  action->type = ACTION_PLAY;
+  action->hand_value = cardValue(index);
+  action->hand_spice = cardSpice(index);
+  action->claimed_value = claimed_value;
+  action->claimed_spice = claimed_spice;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Strategy choosing uniformly between the possible actions, lying about half of its plays.
+/// @param view The state of the game visible to the player.
+/// @param action A pointer to the action to fill in.
+/// @param context Unused.
+static void strategyRandom(const TurnView *view, Action *action, void *context)
+{
+  (void)context;
+  int roll = randomBelow(view->rng, 100);
+
+  if (view->opponent->has_played && roll < 25)
+  {
+    action->type = ACTION_CHALLENGE;
+    action->challenge_value = randomBelow(view->rng, 2);
+  }
+  else if (!handIsEmpty(&view->self->hand) && roll < 85)
+  {
+    const Hand *hand = &view->self->hand;
+    int index = handFirst(hand);
+    for (int skip = randomBelow(view->rng, hand->size); skip >= hand->counts[index]; index = handNext(hand, index))
+    {
+      skip -= hand->counts[index];
+    }
+
+    if (randomBelow(view->rng, 2))
+    {
+      playAction(action, index, cardValue(index), cardSpice(index));
+    }
+    else
+    {
+      int value = randomBelow(view->rng, 10) + 1;
+      char spice = SPICES[randomBelow(view->rng, 3)];
+      playAction(action, index, value, spice);
+    }
+  }
+  else
+  {
+    action->type = ACTION_DRAW;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Strategy that always plays its lowest hand card truthfully and never challenges.
+/// @param view The state of the game visible to the player.
+/// @param action A pointer to the action to fill in.
+/// @param context Unused.
+static void strategyHonest(const TurnView *view, Action *action, void *context)
+{
+  (void)context;
+  int index = handFirst(&view->self->hand);
+  if (index >= 0)
+    playAction(action, index, cardValue(index), cardSpice(index));
+  else
+    action->type = ACTION_DRAW;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Strategy that always plays its lowest hand card claiming a random card, and challenges the value of the
+/// opponent's claim once three or more cards are at stake.
+/// @param view The state of the game visible to the player.
+/// @param action A pointer to the action to fill in.
+/// @param context Unused.
+static void strategyLiar(const TurnView *view, Action *action, void *context)
+{
+  (void)context;
+  if (view->opponent->has_played && view->cards_played_this_round >= 3)
+  {
+    action->type = ACTION_CHALLENGE;
+    action->challenge_value = 1;
+  }
+  else if (!handIsEmpty(&view->self->hand))
+  {
+    int value = randomBelow(view->rng, 10) + 1;
+    char spice = SPICES[randomBelow(view->rng, 3)];
+    playAction(action, handFirst(&view->self->hand), value, spice);
+  }
+  else
+  {
+    action->type = ACTION_DRAW;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Strategy that challenges every claim of the opponent on a random property and otherwise plays truthfully.
+/// @param view The state of the game visible to the player.
+/// @param action A pointer to the action to fill in.
+/// @param context Unused.
+static void strategySkeptic(const TurnView *view, Action *action, void *context)
+{
+  (void)context;
+  if (view->opponent->has_played)
+  {
+    action->type = ACTION_CHALLENGE;
+    action->challenge_value = randomBelow(view->rng, 2);
+  }
+  else
+  {
+    strategyHonest(view, action, context);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Strategy that counts cards and challenges a claim once it is more likely false than true, trusting a claim of a
+/// card that can still be hidden half of the time. Otherwise it plays like the honest strategy.
+/// @param view The state of the game visible to the player.
+/// @param action A pointer to the action to fill in.
+/// @param context Unused.
+static void strategyCounter(const TurnView *view, Action *action, void *context)
+{
+  if (view->tracker && view->opponent->has_played)
+  {
+    ClaimOdds odds;
+    const Card *claim = &view->opponent->claimed_card;
+    claimOdds(view->tracker, claim->value, claim->spice, &odds);
+    double distrust = odds.claim_unseen ? 0.5 : 1.0;
+    if (distrust * odds.value_lie > 0.5 || distrust * odds.spice_lie > 0.5)
+    {
+      action->type = ACTION_CHALLENGE;
+      action->challenge_value = odds.value_lie >= odds.spice_lie;
+      return;
+    }
+  }
+  strategyHonest(view, action, context);
+}
+
+static const Seat STRATEGIES[] = {
+  {"random", strategyRandom, NULL},
+  {"honest", strategyHonest, NULL},
+  {"liar", strategyLiar, NULL},
+  {"skeptic", strategySkeptic, NULL},
+  {"counter", strategyCounter, NULL},
+  {"ismcts", strategyIsmcts, (void *)&ISMCTS_DEFAULTS},
+  {"endgame", strategyEndgame, NULL},
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Gives access to the table of built-in strategies.
+/// @param strategies A pointer to the variable receiving the table.
+/// @return The number of strategies in the table.
+int listStrategies(const Seat **strategies)
+{
+  *strategies = STRATEGIES;
+  return (int)(sizeof(STRATEGIES) / sizeof(STRATEGIES[0]));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Looks up a built-in strategy by its name.
+/// @param name The name of the strategy.
+/// @param seat A pointer to the seat receiving the strategy.
+/// @return 0 if the strategy exists; 1 otherwise.
+int findStrategy(const char *name, Seat *seat)
+{
+  for (size_t i = 0; i < sizeof(STRATEGIES) / sizeof(STRATEGIES[0]); i++)
+  {
+    if (strcmp(STRATEGIES[i].name, name) == 0)
+    {
+      *seat = STRATEGIES[i];
+      return 0;
+    }
+  }
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a strategy can play with a variant of the rules. The search strategies play out their own games
+/// with the standard rules.
+/// @param seat A pointer to the seat.
+/// @return 1 if the strategy only decides from its view of the game; 0 for a search strategy.
+int playsVariantRules(const Seat *seat)
+{
+  return seat->decide != strategyIsmcts && seat->decide != strategyEndgame;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a strategy always makes the same move in the same position, without using the random generator.
+/// @param seat A pointer to the seat.
+/// @return 1 for the honest, card counting and endgame strategies; 0 otherwise.
+int playsDeterministically(const Seat *seat)
+{
+  return seat->decide == strategyHonest || seat->decide == strategyCounter || seat->decide == strategyEndgame;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Lets a strategy take one turn, mirroring playerTurn without reading input or printing anything.
+/// Actions that are not allowed in the current state are replaced by drawing a card.
+/// @param seat The seat deciding the action.
+/// @param state A pointer to the state of the game.
+/// @param deck_counts The number of cards of each kind in the deck of the game.
+/// @param trackers The card counts of player 1 and player 2, updated with the cards seen in the turn.
+/// @param rng A pointer to the random generator handed to the strategy.
+/// @param log A pointer to the event log recording the turn, or NULL.
+/// @param tally A pointer to the tally counting the challenges, or NULL.
+static void simulateTurn(const Seat *seat, GameState *state, const uint16_t *deck_counts, CardTracker trackers[2],
+                         uint64_t *rng, EventLog *log, GameTally *tally)
+{
+  int seat_index = state->seat;
+  TurnView view = {&state->players[seat_index], &state->players[1 - seat_index], &state->draw_pile,
+                   state->cards_played_this_round, state->latest_card_number, state->latest_card_spice, rng,
+                   deck_counts, &trackers[seat_index], seat_index};
+  Action action = {ACTION_DRAW, 0, '\0', 0, '\0', 0};
+  STATS_START(decide_started);
+  seat->decide(&view, &action, seat->context);
+  STATS_STOP(PHASE_DECIDE, decide_started);
+
+  if (!isLegalMove(state, &action))
+  {
+    action.type = ACTION_DRAW;
+  }
+
+  if (action.type == ACTION_DRAW && !pileIsEmpty(&state->draw_pile))
+  {
+    logDraw(log, seat_index, pilePeek(&state->draw_pile, 0));
+  }
+
+  MoveUndo undo;
+  STATS_START(move_started);
+  applyMove(state, &action, &undo);
+  STATS_STOP(action.type == ACTION_PLAY ? PHASE_LOOKUP : action.type == ACTION_CHALLENGE ? PHASE_CHALLENGE : PHASE_DRAW,
+             move_started);
+  trackMove(trackers, state, &undo);
+
+  if (action.type == ACTION_PLAY)
+  {
+    logPlay(log, seat_index, cardIndex(action.hand_value, action.hand_spice), action.claimed_value,
+            action.claimed_spice);
+  }
+  else if (action.type == ACTION_CHALLENGE)
+  {
+    logChallenge(log, seat_index, action.challenge_value, &undo.result);
+    tallyChallenge(tally, action.challenge_value, &undo.result);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays one complete game between two strategies, mirroring roundWithChallenges.
+/// The draw pile of the game is the rest of the deck array, so nothing is allocated.
+/// @param deck The kind indices of the cards of the deck in dealing order.
+/// @param deck_size The number of cards in the deck.
+/// @param seats The strategies of player 1 and player 2.
+/// @param rules A pointer to a variant of the rules, or NULL for the standard rules.
+/// @param rng A pointer to the random generator handed to the strategies.
+/// @param result A pointer to the structure receiving the outcome of the game.
+/// @param log A pointer to the event log recording the game, or NULL.
+/// @param tally A pointer to the tally the game is added to, or NULL.
+void playGame(const uint8_t *deck, int deck_size, const Seat seats[2], const Rules *rules, uint64_t *rng,
+              GameResult *result, EventLog *log, GameTally *tally)
+{
+  STATS_START(game_started);
+  GameState state;
+  initGameState(&state, deck, deck_size, rules);
+  logDeal(log, deck, deck_size);
+
+  uint16_t deck_counts[CARD_KINDS] = {0};
+  for (int i = 0; i < deck_size; i++)
+  {
+    deck_counts[deck[i]]++;
+  }
+  CardTracker trackers[2];
+  startTracker(&trackers[0], deck_counts, &state.players[0].hand);
+  startTracker(&trackers[1], deck_counts, &state.players[1].hand);
+
+  int turn = 0;
+  while (!gameStateOver(&state))
+  {
+    simulateTurn(&seats[state.seat], &state, deck_counts, trackers, rng, log, tally);
+    turn++;
+  }
+
+  const Player *players = state.players;
+  result->score[0] = players[0].score;
+  result->score[1] = players[1].score;
+  result->winner = players[0].score > players[1].score ? 1 : players[1].score > players[0].score ? 2 : 0;
+  result->turns = turn;
+  logEnd(log, players[0].score, players[1].score);
+  tallyGame(tally, players[0].score, players[1].score, turn);
+  STATS_STOP(PHASE_GAME, game_started);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Shuffles a deck in place with the Fisher-Yates algorithm.
+/// @param kinds The kind indices of the cards to shuffle.
+/// @param deck_size The number of cards.
+/// @param rng A pointer to the random generator.
+void shuffleDeck(uint8_t *kinds, int deck_size, uint64_t *rng)
+{
+  for (int i = deck_size - 1; i > 0; i--)
+  {
+    int j = randomBelow(rng, i + 1);
+    uint8_t temp = kinds[i];
+    kinds[i] = kinds[j];
+    kinds[j] = temp;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the current time in seconds.
+/// @return The seconds since an arbitrary point in time.
+double currentSeconds(void)
+{
+  struct timespec time;
+  timespec_get(&time, TIME_UTC);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the usage of the simulation mode.
+/// @return 1, the exit code for invalid arguments.
+static int simulationUsage(void)
+{
+  printf("Usage: ./a4-csf --simulate <games> [--seed <seed>] [--p1 <strategy>] [--p2 <strategy>] [--ordered] "
+         "[--log <log file>] [--stats] [--save-scores] [--rules <rule file>] [--csv <file>] "
+         "[--json <file>] [--iterations <count>] [--think <ms>] [--search-threads <count>] <config file>\n");
+  printf("       ./a4-csf --simulate <games> [options] --generate <cards> [--values <w1,...,w10>] "
+         "[--spices <wc,wp,ww>]\n");
+  printf("Strategies:");
+  for (size_t i = 0; i < sizeof(STRATEGIES) / sizeof(STRATEGIES[0]); i++)
+  {
+    printf(" %s", STRATEGIES[i].name);
+  }
+  printf("\n");
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Entry point of the simulation mode started with "--simulate".
+/// Plays the requested number of games on the deck of the configuration file, shuffling the deck with a seeded
+/// generator before every game unless "--ordered" is given, and prints the throughput and the results per seat.
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// "--log" records every game in an event log that can be verified with "--replay", and "--stats" prints the time
+/// spent in each phase of a turn. "--generate <cards>" replaces the configuration file by a new random deck for
+/// every game, the same deck that "--generate" with the seed and "--deck <game>" writes. "--save-scores" adds the
+/// results of all games to the score block of the configuration file with a single write after the last game.
+/// "--rules <rule file>" plays a variant of the rules, see loadRules, which the search strategies, "--log" and
+/// "--save-scores" do not support, since they are built for the standard rules. "--csv <file>" or
+/// "--json <file>" aggregates the results, challenges and score margins of all games while they are played and
+/// exports them, see exportTallies.
+/// @return 0 if the simulation finished; 1 for invalid arguments; 2 or 3 for configuration file or log file errors;
+/// 4 if there is not enough memory.
+int runSimulation(int argc, char *argv[])
+{
+  if (argc < 4)
+  {
+    return simulationUsage();
+  }
+
+  char *end = NULL;
+  long long games = strtoll(argv[2], &end, 10);
+  uint64_t seed = 1;
+  int shuffle = 1;
+  int save_scores = 0;
+  int stats = 0;
+  const char *log_path = NULL;
+  const char *rules_path = NULL;
+  const char *export_path = NULL;
+  TallyFormat export_format = TALLY_CSV;
+  Seat seats[2];
+  findStrategy("random", &seats[0]);
+  findStrategy("random", &seats[1]);
+  IsmctsConfig search = ISMCTS_DEFAULTS;
+  DeckSpec spec = DECK_DEFAULTS;
+  const char *config_path = NULL;
+
+  if (*end != '\0' || games < 1)
+  {
+    return simulationUsage();
+  }
+
+  for (int i = 3; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+    {
+      seed = strtoull(argv[++i], NULL, 10);
+    }
+    else if ((strcmp(argv[i], "--p1") == 0 || strcmp(argv[i], "--p2") == 0) && i + 1 < argc)
+    {
+      Seat *seat = &seats[argv[i][3] - '1'];
+      if (findStrategy(argv[++i], seat) != 0)
+      {
+        return simulationUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc)
+    {
+      log_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--rules") == 0 && i + 1 < argc)
+    {
+      rules_path = argv[++i];
+    }
+    else if ((strcmp(argv[i], "--csv") == 0 || strcmp(argv[i], "--json") == 0) && i + 1 < argc)
+    {
+      export_format = argv[i][2] == 'c' ? TALLY_CSV : TALLY_JSON;
+      export_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--ordered") == 0)
+    {
+      shuffle = 0;
+    }
+    else if (strcmp(argv[i], "--stats") == 0)
+    {
+      stats = 1;
+    }
+    else if (strcmp(argv[i], "--save-scores") == 0)
+    {
+      save_scores = 1;
+    }
+    else if (parseDeckOption(argv, &i, argc, &spec) != 0 && parseSearchOption(argv, &i, argc, &search) != 0)
+    {
+      if (i != argc - 1)
+      {
+        return simulationUsage();
+      }
+      config_path = argv[i];
+    }
+  }
+
+  DeckSampler sampler;
+  if (!config_path == !spec.size || (spec.size && (save_scores || initDeckSampler(&sampler, &spec) != 0)) ||
+      (rules_path && (log_path || save_scores || !playsVariantRules(&seats[0]) ||
+                      !playsVariantRules(&seats[1]))))
+  {
+    return simulationUsage();
+  }
+
+  Rules variant;
+  const Rules *rules = NULL;
+  if (rules_path)
+  {
+    int status = loadRules(rules_path, &variant);
+    if (status != CONFIG_OK)
+    {
+      printConfigError(status, rules_path, NULL);
+      return configExitCode(status);
+    }
+    rules = isStandardRules(&variant) ? NULL : &variant;
+  }
+  if (stats)
+  {
+    enableStats();
+  }
+
+  useSearchConfig(&seats[0], &search);
+  useSearchConfig(&seats[1], &search);
+
+  Deck deck = {NULL, spec.size};
+  char generated_name[64];
+  if (spec.size)
+  {
+    snprintf(generated_name, sizeof(generated_name), "generated decks of %d cards", spec.size);
+    config_path = generated_name;
+  }
+  else
+  {
+    char invalid_line[CONFIG_LINE_SIZE];
+    int status = loadConfig(config_path, &deck, invalid_line);
+    if (status != CONFIG_OK)
+    {
+      printConfigError(status, config_path, invalid_line);
+      return configExitCode(status);
+    }
+  }
+
+  uint8_t *game_deck = malloc(deck.size);
+  if (!game_deck)
+  {
+    printf("Error: Out of memory\n");
+    free(deck.kinds);
+    return 4;
+  }
+
+  EventLog *log = NULL;
+  if (log_path && !(log = openEventLog(log_path)))
+  {
+    printf("Error: Cannot open file: %s\n", log_path);
+    free(game_deck);
+    free(deck.kinds);
+    return 2;
+  }
+
+  long long wins[3] = {0, 0, 0};
+  long long total_score[2] = {0, 0};
+  long long total_turns = 0;
+  GameTally tally = {0};
+  uint64_t rng = seed;
+  double start = currentSeconds();
+
+  for (long long game = 0; game < games; game++)
+  {
+    if (spec.size)
+    {
+      generateDeck(&sampler, deck.size, deckSeed(seed, game), game_deck);
+    }
+    else
+    {
+      memcpy(game_deck, deck.kinds, deck.size);
+      if (shuffle)
+      {
+        shuffleDeck(game_deck, deck.size, &rng);
+      }
+    }
+
+    GameResult outcome;
+    playGame(game_deck, deck.size, seats, rules, &rng, &outcome, log, export_path ? &tally : NULL);
+
+    wins[outcome.winner]++;
+    total_score[0] += outcome.score[0];
+    total_score[1] += outcome.score[1];
+    total_turns += outcome.turns;
+
+    if ((game & (STATS_FLUSH_GAMES - 1)) == STATS_FLUSH_GAMES - 1)
+    {
+      statsFlush();
+    }
+  }
+
+  double elapsed = currentSeconds() - start;
+  int log_failed = closeEventLog(log);
+  free(game_deck);
+  free(deck.kinds);
+
+  printf("Simulated %lld games of %s in %.3f s (%.0f games/s)\n", games, config_path, elapsed,
+         elapsed > 0 ? games / elapsed : 0.0);
+  for (int seat = 0; seat < 2; seat++)
+  {
+    printf("Player %d (%s): %lld wins (%.2f%%), mean score %.3f\n", seat + 1, seats[seat].name, wins[seat + 1],
+           100.0 * wins[seat + 1] / games, (double)total_score[seat] / games);
+  }
+  printf("Ties: %lld (%.2f%%)\n", wins[0], 100.0 * wins[0] / games);
+  printf("Mean turns per game: %.2f\n", (double)total_turns / games);
+  if (rules_path)
+  {
+    printf("Rules: hand %d, penalty %d, bonus %d\n", variant.hand_size, variant.penalty_cards,
+           variant.empty_hand_bonus);
+  }
+  printStats();
+  if (log_failed)
+  {
+    printf("Error: Cannot write file: %s\n", log_path);
+    return 2;
+  }
+
+  TallyLabel label = {config_path, seats[0].name, seats[1].name};
+  if (export_path && exportTallies(export_path, export_format, &label, &tally, 1) != 0)
+  {
+    printf("Error: Cannot write file: %s\n", export_path);
+    return 2;
+  }
+
+  if (save_scores)
+  {
+    ScoreTotals results = {games, {wins[1], wins[2]}, wins[0], {total_score[0], total_score[1]}};
+    int status = saveScores(config_path, &results);
+    if (status != CONFIG_OK)
+    {
+      printConfigError(status, config_path, NULL);
+      return configExitCode(status);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Headless batch simulation of "Entertaining Spice Pretending".
+//
+// Both seats are driven by in-process strategy callbacks instead of stdin, and no narration is printed while the
+// games are running, so a deck configuration can be evaluated over millions of games.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+#include <stdint.h>
+
+#include "engine.h"
+#include "eventlog.h"
+#include "state.h"
+#include "tally.h"
+#include "tracker.h"
+
+// The state of the game visible to the player to move, whose seat is 0 for player 1 and 1 for player 2. deck_counts
+// and tracker are NULL if the deck is not known.
+typedef struct TurnView
+{
+  const Player *self;
+  const Player *opponent;
+  const DrawPile *draw_pile;
+  int cards_played_this_round;
+  int latest_card_number;
+  int latest_card_spice;
+  uint64_t *rng;
+  const uint16_t *deck_counts;
+  const CardTracker *tracker;
+  int seat;
+} TurnView;
+
+typedef void (*Strategy)(const TurnView *view, Action *action, void *context);
+
+typedef struct Seat
+{
+  const char *name;
+  Strategy decide;
+  void *context;
+} Seat;
+
+typedef struct GameResult
+{
+  int winner;
+  int score[2];
+  int turns;
+} GameResult;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Advances a splitmix64 generator and returns the next pseudo random number.
+/// @param state A pointer to the generator state.
+/// @return A uniformly distributed 64-bit number.
+static inline uint64_t nextRandom(uint64_t *state)
+{
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns a pseudo random number in the range [0, bound).
+/// @param state A pointer to the generator state.
+/// @param bound The exclusive upper bound, must be greater than 0.
+/// @return The pseudo random number.
+static inline int randomBelow(uint64_t *state, int bound)
+{
+  return (int)(((nextRandom(state) >> 32) * (uint64_t)bound) >> 32);
+}
+
+int listStrategies(const Seat **strategies);
+int findStrategy(const char *name, Seat *seat);
+int playsVariantRules(const Seat *seat);
+int playsDeterministically(const Seat *seat);
+void shuffleDeck(uint8_t *kinds, int deck_size, uint64_t *rng);
+double currentSeconds(void);
+void playGame(const uint8_t *deck, int deck_size, const Seat seats[2], const Rules *rules, uint64_t *rng,
+              GameResult *result, EventLog *log, GameTally *tally);
+int runSimulation(int argc, char *argv[]);
+
+#endif
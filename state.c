@@ -0,0 +1,168 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Self-contained game state of "Entertaining Spice Pretending" for search-based players.
+//
+// Moves are applied with the rule functions of engine.c, so a game played on a GameState follows exactly the same
+// rules as the interactive game. A move changes at most a handful of fields and takes at most two cards from the
+// draw pile, which is all the information undoMove needs.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdlib.h>
+
+#include "state.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Deals a deck and sets up the state at the start of a game with player 1 to move.
+/// @param state A pointer to the state to set up.
+/// @param deck The kind indices of the cards in dealing order. It must stay valid while the state is used.
+/// @param deck_size The number of cards in the deck.
+/// @param rules A pointer to a variant of the rules, which must stay valid while the state is used, or NULL for
+/// the standard rules.
+void initGameState(GameState *state, const uint8_t *deck, int deck_size, const Rules *rules)
+{
+  Player empty = {{0, 0, {0}}, 0, 0, {0, '\0'}, {0, '\0'}};
+  state->players[0] = empty;
+  state->players[1] = empty;
+  state->rules = rules;
+  state->cards_played_this_round = 0;
+  state->latest_card_number = 0;
+  state->latest_card_spice = '\0';
+  state->seat = 0;
+  state->game_over = 0;
+
+  if (rules)
+  {
+    distributeVariantCards(deck, deck_size, &state->players[0], &state->players[1], &state->draw_pile, rules);
+  }
+  else
+  {
+    distributeCards(deck, deck_size, &state->players[0], &state->players[1], &state->draw_pile);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether the player to move may make a move. Drawing is always allowed, and ends the game if the draw
+/// pile is empty.
+/// @param state A pointer to the game state.
+/// @param move A pointer to the move.
+/// @return 1 if the move is legal; 0 otherwise.
+int isLegalMove(const GameState *state, const Action *move)
+{
+  switch (move->type)
+  {
+    case ACTION_PLAY:
+      return handHolds(&state->players[state->seat].hand, cardIndex(move->hand_value, move->hand_spice));
+    case ACTION_CHALLENGE:
+      return state->players[1 - state->seat].has_played;
+    default:
+      return 1;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Makes a legal move for the player to move and passes the turn to the other player.
+/// @param state A pointer to the game state.
+/// @param move A pointer to the move, checked with isLegalMove.
+/// @param undo A pointer to the record receiving what is needed to undo the move. For a challenge it also holds
+/// the outcome in result.
+void applyMove(GameState *state, const Action *move, MoveUndo *undo)
+{
+  int seat = state->seat;
+  Player *current_player = &state->players[seat];
+  Player *opponent = &state->players[1 - seat];
+
+  undo->type = move->type;
+  undo->seat = seat;
+  undo->receiver = -1;
+  undo->draw_top = state->draw_pile.top;
+  undo->game_over = state->game_over;
+
+  if (move->type == ACTION_PLAY)
+  {
+    undo->cards_played_this_round = state->cards_played_this_round;
+    undo->latest_card_number = state->latest_card_number;
+    undo->latest_card_spice = state->latest_card_spice;
+    undo->has_played[seat] = current_player->has_played;
+    undo->latest_card = current_player->latest_card;
+    undo->claimed_card = current_player->claimed_card;
+    playCard(current_player, move->hand_value, move->hand_spice, move->claimed_value, move->claimed_spice,
+             &state->cards_played_this_round, &state->latest_card_number, &state->latest_card_spice);
+  }
+  else if (move->type == ACTION_CHALLENGE)
+  {
+    undo->cards_played_this_round = state->cards_played_this_round;
+    undo->score[0] = state->players[0].score;
+    undo->score[1] = state->players[1].score;
+    undo->has_played[0] = state->players[0].has_played;
+    undo->has_played[1] = state->players[1].has_played;
+    if (state->rules)
+    {
+      resolveVariantChallenge(current_player, opponent, move->challenge_value, &state->cards_played_this_round,
+                              &state->draw_pile, state->rules, &undo->result);
+    }
+    else
+    {
+      resolveChallenge(current_player, opponent, move->challenge_value, &state->cards_played_this_round,
+                       &state->draw_pile, &undo->result);
+    }
+    undo->receiver = undo->result.successful ? 1 - seat : seat;
+    state->game_over = pileIsEmpty(&state->draw_pile);
+  }
+  else if (pileIsEmpty(&state->draw_pile))
+  {
+    state->game_over = 1;
+  }
+  else
+  {
+    drawCard(current_player, &state->draw_pile);
+    undo->receiver = seat;
+    state->game_over = pileIsEmpty(&state->draw_pile);
+  }
+
+  state->seat = 1 - seat;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Takes back the latest move applied to a state. Moves have to be undone in reverse order.
+/// @param state A pointer to the game state.
+/// @param undo A pointer to the record filled in by applyMove.
+void undoMove(GameState *state, const MoveUndo *undo)
+{
+  Player *current_player = &state->players[undo->seat];
+
+  if (undo->type == ACTION_PLAY)
+  {
+    handAdd(&current_player->hand, cardIndex(current_player->latest_card.value, current_player->latest_card.spice));
+    current_player->has_played = undo->has_played[undo->seat];
+    current_player->latest_card = undo->latest_card;
+    current_player->claimed_card = undo->claimed_card;
+    state->cards_played_this_round = undo->cards_played_this_round;
+    state->latest_card_number = undo->latest_card_number;
+    state->latest_card_spice = undo->latest_card_spice;
+  }
+  else if (undo->type == ACTION_CHALLENGE)
+  {
+    state->players[0].score = undo->score[0];
+    state->players[1].score = undo->score[1];
+    state->players[0].has_played = undo->has_played[0];
+    state->players[1].has_played = undo->has_played[1];
+    state->cards_played_this_round = undo->cards_played_this_round;
+  }
+
+  if (undo->receiver >= 0)
+  {
+    Hand *hand = &state->players[undo->receiver].hand;
+    for (int i = undo->draw_top; i < state->draw_pile.top; i++)
+    {
+      handRemove(hand, state->draw_pile.kinds[i]);
+    }
+  }
+
+  state->draw_pile.top = undo->draw_top;
+  state->game_over = undo->game_over;
+  state->seat = undo->seat;
+}
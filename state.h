@@ -0,0 +1,96 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Self-contained game state of "Entertaining Spice Pretending" for search-based players.
+//
+// A GameState holds everything that decides the rest of a game in one fixed-size struct: both players, the draw
+// pile, the round counters and the seat to move. It is cloned by plain assignment, and a move is applied and undone
+// in constant time, so a search can explore many hypothetical continuations of one game.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef STATE_H
+#define STATE_H
+
+#include "engine.h"
+
+typedef enum ActionType
+{
+  ACTION_DRAW,
+  ACTION_PLAY,
+  ACTION_CHALLENGE
+} ActionType;
+
+typedef struct Action
+{
+  ActionType type;
+  int hand_value;
+  char hand_spice;
+  int claimed_value;
+  char claimed_spice;
+  int challenge_value;
+} Action;
+
+// The draw pile points into the deck array of the game, which is never modified after dealing, so every clone of a
+// state shares the same cards. rules is NULL for the standard rules, which take the faster path of the rule
+// functions with the constants built in.
+typedef struct GameState
+{
+  Player players[2];
+  const Rules *rules;
+  DrawPile draw_pile;
+  int cards_played_this_round;
+  int latest_card_number;
+  int latest_card_spice;
+  int seat;
+  int game_over;
+} GameState;
+
+// What applyMove changes besides the hands, so that undoMove can restore it. Only the fields touched by the type of
+// the move are saved. Cards taken from the draw pile are the ones between the saved and the current top of the pile.
+typedef struct MoveUndo
+{
+  ActionType type;
+  int seat;
+  int receiver;
+  int draw_top;
+  int cards_played_this_round;
+  int latest_card_number;
+  int latest_card_spice;
+  int game_over;
+  int score[2];
+  int has_played[2];
+  Card latest_card;
+  Card claimed_card;
+  ChallengeResult result;
+} MoveUndo;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Copies a game state. The copy can be played on independently of the original.
+/// @param copy A pointer to the state receiving the copy.
+/// @param state A pointer to the state to copy.
+static inline void cloneGameState(GameState *copy, const GameState *state)
+{
+  *copy = *state;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Checks whether a game is over, either because it was ended by a move or because no cards are left. Like in the
+/// interactive game, running out of cards only ends the game before the turn of player 1, so player 2 always gets
+/// to answer the last play of player 1.
+/// @param state A pointer to the game state.
+/// @return 1 if the game is over; 0 otherwise.
+static inline int gameStateOver(const GameState *state)
+{
+  return state->game_over || (state->seat == 0 && pileIsEmpty(&state->draw_pile) &&
+                              handIsEmpty(&state->players[0].hand) && handIsEmpty(&state->players[1].hand));
+}
+
+void initGameState(GameState *state, const uint8_t *deck, int deck_size, const Rules *rules);
+int isLegalMove(const GameState *state, const Action *move);
+void applyMove(GameState *state, const Action *move, MoveUndo *undo);
+void undoMove(GameState *state, const MoveUndo *undo);
+
+#endif
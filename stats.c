@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Instrumentation of "Entertaining Spice Pretending".
+//
+// A duration is counted in the histogram bucket of its bit length, so bucket b holds the durations from 2^(b-1) up
+// to 2^b - 1 nanoseconds and percentiles are reported as the upper bound of their bucket. The thread-local counters
+// are merged into the totals under a lock by statsFlush, which also prints a snapshot of the totals every
+// SNAPSHOT_SECONDS during long runs.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+
+#define HISTOGRAM_BUCKETS 40
+#define SNAPSHOT_SECONDS 5.0
+
+typedef struct PhaseCounters
+{
+  uint64_t count;
+  uint64_t total;
+  uint64_t max;
+  uint64_t buckets[HISTOGRAM_BUCKETS];
+} PhaseCounters;
+
+typedef struct StatsCounters
+{
+  PhaseCounters phases[PHASE_COUNT];
+} StatsCounters;
+
+static const char *const PHASE_NAMES[PHASE_COUNT] = {"input", "decide", "lookup", "sort",
+                                                     "challenge", "draw", "output", "game"};
+
+int stats_enabled = 0;
+
+static _Thread_local StatsCounters local_counters;
+static StatsCounters total_counters;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t stats_started;
+static uint64_t last_snapshot;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the time of a monotonic clock.
+/// @return The nanoseconds since an arbitrary point in time.
+uint64_t statsNow(void)
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000u + (uint64_t)time.tv_nsec;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Records one execution of a phase in the counters of the calling thread.
+/// @param phase The phase.
+/// @param start The time the phase started at, see statsNow.
+void statsRecord(StatsPhase phase, uint64_t start)
+{
+  uint64_t elapsed = statsNow() - start;
+  PhaseCounters *counters = &local_counters.phases[phase];
+  int bucket = elapsed ? 64 - __builtin_clzll(elapsed) : 0;
+
+  counters->count++;
+  counters->total += elapsed;
+  if (elapsed > counters->max)
+  {
+    counters->max = elapsed;
+  }
+  counters->buckets[bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1]++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Turns the instrumentation on. It has to be called before any thread records a phase.
+void enableStats(void)
+{
+  stats_enabled = 1;
+  stats_started = statsNow();
+  last_snapshot = stats_started;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Returns the upper bound of the histogram bucket a percentile falls into.
+/// @param counters A pointer to the counters of a phase.
+/// @param percent The percentile.
+/// @return The upper bound in nanoseconds, at most the longest recorded duration.
+static uint64_t percentile(const PhaseCounters *counters, int percent)
+{
+  uint64_t rank = (counters->count * percent + 99) / 100;
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+  {
+    seen += counters->buckets[bucket];
+    if (seen >= rank && seen > 0)
+    {
+      uint64_t bound = bucket ? (1ULL << bucket) - 1 : 0;
+      return bound < counters->max ? bound : counters->max;
+    }
+  }
+  return counters->max;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints a table of the merged counters of every phase that has been recorded. The caller holds the lock.
+static void printTotals(void)
+{
+  printf("Statistics after %.3f s:\n", (statsNow() - stats_started) / 1e9);
+  printf("%-10s %12s %12s %10s %10s %10s %10s %12s\n", "phase", "count", "total ms", "mean ns", "p50 ns", "p90 ns",
+         "p99 ns", "max ns");
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    const PhaseCounters *counters = &total_counters.phases[phase];
+    if (counters->count == 0)
+    {
+      continue;
+    }
+    printf("%-10s %12llu %12.3f %10.0f %10llu %10llu %10llu %12llu\n", PHASE_NAMES[phase],
+           (unsigned long long)counters->count, counters->total / 1e6, (double)counters->total / counters->count,
+           (unsigned long long)percentile(counters, 50), (unsigned long long)percentile(counters, 90),
+           (unsigned long long)percentile(counters, 99), (unsigned long long)counters->max);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds the counters of the calling thread to the totals and clears them. Prints a snapshot of the totals if the
+/// latest one is at least SNAPSHOT_SECONDS old. Does nothing unless statistics are enabled.
+void statsFlush(void)
+{
+  if (!stats_enabled)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&stats_lock);
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    PhaseCounters *total = &total_counters.phases[phase];
+    const PhaseCounters *local = &local_counters.phases[phase];
+    total->count += local->count;
+    total->total += local->total;
+    total->max = local->max > total->max ? local->max : total->max;
+    for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+    {
+      total->buckets[bucket] += local->buckets[bucket];
+    }
+  }
+  memset(&local_counters, 0, sizeof(local_counters));
+
+  uint64_t now = statsNow();
+  if (now - last_snapshot >= SNAPSHOT_SECONDS * 1e9)
+  {
+    last_snapshot = now;
+    printTotals();
+    fflush(stdout);
+  }
+  pthread_mutex_unlock(&stats_lock);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the summary of all phases with the latency histogram of each, after merging the counters of the calling
+/// thread. The other threads have to be flushed already. Does nothing unless statistics are enabled.
+void printStats(void)
+{
+  if (!stats_enabled)
+  {
+    return;
+  }
+#ifdef NO_STATS
+  printf("Statistics: not available in a build with NO_STATS\n");
+#else
+  last_snapshot = statsNow();
+  statsFlush();
+
+  pthread_mutex_lock(&stats_lock);
+  printf("\n");
+  printTotals();
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    const PhaseCounters *counters = &total_counters.phases[phase];
+    if (counters->count == 0)
+    {
+      continue;
+    }
+    printf("Latency histogram of %s:\n", PHASE_NAMES[phase]);
+    for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+    {
+      if (counters->buckets[bucket] > 0)
+      {
+        printf("  < %12llu ns: %llu\n", 1ULL << bucket, (unsigned long long)counters->buckets[bucket]);
+      }
+    }
+  }
+  pthread_mutex_unlock(&stats_lock);
+#endif
+}
@@ -0,0 +1,57 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Instrumentation of "Entertaining Spice Pretending".
+//
+// Counts and latency histograms for the phases of a turn and for complete games, enabled at run time with
+// "--stats". Every thread records into its own counters, which are merged into the totals with statsFlush, so
+// recording never takes a lock. Building with -DNO_STATS compiles the instrumentation out entirely.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+typedef enum StatsPhase
+{
+  PHASE_INPUT,
+  PHASE_DECIDE,
+  PHASE_LOOKUP,
+  PHASE_SORT,
+  PHASE_CHALLENGE,
+  PHASE_DRAW,
+  PHASE_OUTPUT,
+  PHASE_GAME,
+  PHASE_COUNT
+} StatsPhase;
+
+extern int stats_enabled;
+
+uint64_t statsNow(void);
+void statsRecord(StatsPhase phase, uint64_t start);
+void enableStats(void);
+void statsFlush(void);
+void printStats(void);
+
+#ifdef NO_STATS
+#define STATS_START(timer)
+#define STATS_STOP(phase, timer)
+#else
+// Starts a timer for a phase. It only reads the clock if statistics are enabled.
+#define STATS_START(timer) uint64_t timer = stats_enabled ? statsNow() : 0
+// Records the time since the matching STATS_START for a phase.
+#define STATS_STOP(phase, timer) \
+  do                             \
+  {                              \
+    if (stats_enabled)           \
+    {                            \
+      statsRecord(phase, timer); \
+    }                            \
+  } while (0)
+#endif
+
+#endif
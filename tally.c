@@ -0,0 +1,285 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Streaming aggregation of the results of many games of "Entertaining Spice Pretending".
+//
+// Adding a challenge or a game only increments a few counters, and merging adds the counters of two tallies. The
+// CSV export is in long format with one count per line, so that it can be loaded into any table tool without
+// knowing the histogram sizes; the JSON export keeps the histograms as objects with only the buckets that were hit.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdio.h>
+
+#include "tally.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds a resolved challenge to a tally.
+/// @param tally A pointer to the tally, or NULL to ignore the challenge.
+/// @param challenge_value 1 if the value was challenged; 0 if the spice was challenged.
+/// @param result A pointer to the outcome of the challenge. Its points are the cards played in the round.
+void tallyChallenge(GameTally *tally, int challenge_value, const ChallengeResult *result)
+{
+  if (!tally)
+  {
+    return;
+  }
+
+  tally->challenges[challenge_value != 0][result->successful != 0]++;
+  tally->round_cards[result->points < TALLY_ROUND_LIMIT ? result->points : TALLY_ROUND_LIMIT]++;
+  tally->bonuses += result->bonus != 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds a finished game to a tally.
+/// @param tally A pointer to the tally, or NULL to ignore the game.
+/// @param score1 The final score of player 1.
+/// @param score2 The final score of player 2.
+/// @param turns The number of turns of the game.
+void tallyGame(GameTally *tally, int score1, int score2, int turns)
+{
+  if (!tally)
+  {
+    return;
+  }
+
+  int margin = score1 - score2;
+  if (margin < -TALLY_MARGIN_LIMIT)
+  {
+    margin = -TALLY_MARGIN_LIMIT;
+  }
+  else if (margin > TALLY_MARGIN_LIMIT)
+  {
+    margin = TALLY_MARGIN_LIMIT;
+  }
+  tally->games++;
+  tally->wins[score1 > score2 ? 1 : score2 > score1 ? 2 : 0]++;
+  tally->score[0] += score1;
+  tally->score[1] += score2;
+  tally->turns += turns;
+  tally->margins[margin + TALLY_MARGIN_LIMIT]++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds the counters of one tally to another.
+/// @param total A pointer to the tally receiving the counters.
+/// @param part A pointer to the tally to add.
+void mergeTally(GameTally *total, const GameTally *part)
+{
+  const long long *from = (const long long *)part;
+  long long *to = (long long *)total;
+  for (size_t i = 0; i < sizeof(GameTally) / sizeof(long long); i++)
+  {
+    to[i] += from[i];
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes a string as a CSV field, quoting it if it contains a separator, a quote or a line break.
+/// @param file The file to write to.
+/// @param text The string.
+static void writeCsvField(FILE *file, const char *text)
+{
+  int quoted = 0;
+  for (const char *current = text; *current; current++)
+  {
+    quoted |= *current == ',' || *current == '"' || *current == '\n' || *current == '\r';
+  }
+  if (!quoted)
+  {
+    fputs(text, file);
+    return;
+  }
+
+  fputc('"', file);
+  for (const char *current = text; *current; current++)
+  {
+    if (*current == '"')
+    {
+      fputc('"', file);
+    }
+    fputc(*current, file);
+  }
+  fputc('"', file);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes one count of a tally as a CSV line.
+/// @param file The file to write to.
+/// @param label A pointer to the label of the tally.
+/// @param metric The name of the counted quantity.
+/// @param bucket The bucket of the count within the metric, or "" if the metric has only one.
+/// @param count The count.
+static void writeCsvCount(FILE *file, const TallyLabel *label, const char *metric, const char *bucket, long long count)
+{
+  writeCsvField(file, label->deck);
+  fputc(',', file);
+  writeCsvField(file, label->player1);
+  fputc(',', file);
+  writeCsvField(file, label->player2);
+  fprintf(file, ",%s,%s,%lld\n", metric, bucket, count);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes a tally as CSV lines of the form "deck,player1,player2,metric,bucket,count". The buckets of the round and
+/// margin histograms are only written if they are not 0.
+/// @param file The file to write to.
+/// @param label A pointer to the label of the tally.
+/// @param tally A pointer to the tally.
+static void writeCsvTally(FILE *file, const TallyLabel *label, const GameTally *tally)
+{
+  static const char *const CHALLENGE_BUCKETS[2][2] = {{"spice_failed", "spice_successful"},
+                                                      {"value_failed", "value_successful"}};
+  char bucket[16];
+
+  writeCsvCount(file, label, "games", "", tally->games);
+  writeCsvCount(file, label, "wins", "player1", tally->wins[1]);
+  writeCsvCount(file, label, "wins", "player2", tally->wins[2]);
+  writeCsvCount(file, label, "wins", "tie", tally->wins[0]);
+  writeCsvCount(file, label, "points", "player1", tally->score[0]);
+  writeCsvCount(file, label, "points", "player2", tally->score[1]);
+  writeCsvCount(file, label, "turns", "", tally->turns);
+  writeCsvCount(file, label, "bonuses", "", tally->bonuses);
+  for (int type = 1; type >= 0; type--)
+  {
+    for (int outcome = 1; outcome >= 0; outcome--)
+    {
+      writeCsvCount(file, label, "challenges", CHALLENGE_BUCKETS[type][outcome], tally->challenges[type][outcome]);
+    }
+  }
+  for (int cards = 0; cards <= TALLY_ROUND_LIMIT; cards++)
+  {
+    if (tally->round_cards[cards])
+    {
+      snprintf(bucket, sizeof(bucket), "%d", cards);
+      writeCsvCount(file, label, "round_cards", bucket, tally->round_cards[cards]);
+    }
+  }
+  for (int i = 0; i <= 2 * TALLY_MARGIN_LIMIT; i++)
+  {
+    if (tally->margins[i])
+    {
+      snprintf(bucket, sizeof(bucket), "%d", i - TALLY_MARGIN_LIMIT);
+      writeCsvCount(file, label, "margin", bucket, tally->margins[i]);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes a string as a JSON string literal.
+/// @param file The file to write to.
+/// @param text The string.
+static void writeJsonString(FILE *file, const char *text)
+{
+  fputc('"', file);
+  for (const unsigned char *current = (const unsigned char *)text; *current; current++)
+  {
+    if (*current == '"' || *current == '\\')
+    {
+      fprintf(file, "\\%c", *current);
+    }
+    else if (*current < 0x20)
+    {
+      fprintf(file, "\\u%04x", *current);
+    }
+    else
+    {
+      fputc(*current, file);
+    }
+  }
+  fputc('"', file);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes the buckets of a histogram that are not 0 as a JSON object.
+/// @param file The file to write to.
+/// @param counts The counts of the buckets.
+/// @param size The number of buckets.
+/// @param first The number of the first bucket.
+static void writeJsonHistogram(FILE *file, const long long *counts, int size, int first)
+{
+  const char *separator = "";
+  fputc('{', file);
+  for (int i = 0; i < size; i++)
+  {
+    if (counts[i])
+    {
+      fprintf(file, "%s\"%d\": %lld", separator, first + i, counts[i]);
+      separator = ", ";
+    }
+  }
+  fputc('}', file);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes a tally as a JSON object.
+/// @param file The file to write to.
+/// @param label A pointer to the label of the tally.
+/// @param tally A pointer to the tally.
+static void writeJsonTally(FILE *file, const TallyLabel *label, const GameTally *tally)
+{
+  fprintf(file, "    {\"deck\": ");
+  writeJsonString(file, label->deck);
+  fprintf(file, ", \"player1\": ");
+  writeJsonString(file, label->player1);
+  fprintf(file, ", \"player2\": ");
+  writeJsonString(file, label->player2);
+  fprintf(file,
+          ",\n     \"games\": %lld, \"wins\": [%lld, %lld], \"ties\": %lld, \"points\": [%lld, %lld], "
+          "\"turns\": %lld, \"bonuses\": %lld,\n"
+          "     \"challenges\": {\"value\": {\"successful\": %lld, \"failed\": %lld}, "
+          "\"spice\": {\"successful\": %lld, \"failed\": %lld}},\n     \"round_cards\": ",
+          tally->games, tally->wins[1], tally->wins[2], tally->wins[0], tally->score[0], tally->score[1],
+          tally->turns, tally->bonuses, tally->challenges[1][1], tally->challenges[1][0], tally->challenges[0][1],
+          tally->challenges[0][0]);
+  writeJsonHistogram(file, tally->round_cards, TALLY_ROUND_LIMIT + 1, 0);
+  fprintf(file, ",\n     \"margins\": ");
+  writeJsonHistogram(file, tally->margins, 2 * TALLY_MARGIN_LIMIT + 1, -TALLY_MARGIN_LIMIT);
+  fprintf(file, "}");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Writes tallies to a file. The CSV format has one line per count with the columns
+/// "deck,player1,player2,metric,bucket,count"; the JSON format is an object with the histogram limits and an array
+/// of one object per tally. In both, the outermost buckets of the margin histogram and the last bucket of the round
+/// histogram also count everything beyond them.
+/// @param path The path of the file to write.
+/// @param format The format of the file.
+/// @param labels The labels of the tallies.
+/// @param tallies The tallies.
+/// @param count The number of tallies.
+/// @return 0 if the file was written; 1 otherwise.
+int exportTallies(const char *path, TallyFormat format, const TallyLabel *labels, const GameTally *tallies,
+                  int count)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+  {
+    return 1;
+  }
+
+  if (format == TALLY_CSV)
+  {
+    fprintf(file, "deck,player1,player2,metric,bucket,count\n");
+    for (int i = 0; i < count; i++)
+    {
+      writeCsvTally(file, &labels[i], &tallies[i]);
+    }
+  }
+  else
+  {
+    fprintf(file, "{\n  \"margin_limit\": %d,\n  \"round_limit\": %d,\n  \"results\": [\n", TALLY_MARGIN_LIMIT,
+            TALLY_ROUND_LIMIT);
+    for (int i = 0; i < count; i++)
+    {
+      writeJsonTally(file, &labels[i], &tallies[i]);
+      fprintf(file, "%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+  }
+
+  int failed = ferror(file);
+  return (fclose(file) != 0) | failed;
+}
@@ -0,0 +1,61 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Streaming aggregation of the results of many games of "Entertaining Spice Pretending".
+//
+// A tally is a fixed-size block of counters that games are added to as they finish, so a run of any length needs
+// the same memory and never keeps anything per game. Every thread adds to its own tallies, which are merged once
+// the run is over, and the merged tallies can be exported as CSV or JSON for offline analysis.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef TALLY_H
+#define TALLY_H
+
+#include "engine.h"
+
+// Score margins beyond this many points are counted in the outermost bucket of the margin histogram.
+#define TALLY_MARGIN_LIMIT 100
+
+// Challenges with more cards played in the round are counted in the last bucket of the round histogram.
+#define TALLY_ROUND_LIMIT 31
+
+// wins[0] counts the ties. margins[i] counts the games that player 1 won by i - TALLY_MARGIN_LIMIT points.
+// challenges[type][outcome] counts the spice (type 0) and value (type 1) challenges that failed (outcome 0) or
+// succeeded (outcome 1), and round_cards[n] the challenges made after n cards were played in the round. bonuses
+// counts the successful challenges that emptied the opponent's hand.
+typedef struct GameTally
+{
+  long long games;
+  long long wins[3];
+  long long score[2];
+  long long turns;
+  long long bonuses;
+  long long challenges[2][2];
+  long long round_cards[TALLY_ROUND_LIMIT + 1];
+  long long margins[2 * TALLY_MARGIN_LIMIT + 1];
+} GameTally;
+
+// What the results of a tally belong to, written next to them by exportTallies.
+typedef struct TallyLabel
+{
+  const char *deck;
+  const char *player1;
+  const char *player2;
+} TallyLabel;
+
+typedef enum TallyFormat
+{
+  TALLY_CSV,
+  TALLY_JSON
+} TallyFormat;
+
+void tallyChallenge(GameTally *tally, int challenge_value, const ChallengeResult *result);
+void tallyGame(GameTally *tally, int score1, int score2, int turns);
+void mergeTally(GameTally *total, const GameTally *part);
+int exportTallies(const char *path, TallyFormat format, const TallyLabel *labels, const GameTally *tallies,
+                  int count);
+
+#endif
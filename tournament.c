@@ -0,0 +1,512 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Multi-core self-play tournament of "Entertaining Spice Pretending".
+//
+// The games of every matchup (deck, strategy of player 1, strategy of player 2) are cut into chunks that become
+// the jobs of the work-stealing pool. Each chunk derives its own seed from the tournament seed, so the results do
+// not depend on the number of threads. Every worker accumulates into its own statistics, which are merged once all
+// jobs are done, so the workers never share a write.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "endgame.h"
+#include "ismcts.h"
+#include "pool.h"
+#include "simulate.h"
+#include "stats.h"
+#include "tournament.h"
+
+#define GAMES_PER_JOB 512
+#define MAX_STRATEGIES 16
+
+typedef struct MatchStats
+{
+  long long games;
+  long long wins[3];
+  long long score[2];
+  long long turns;
+} MatchStats;
+
+typedef struct Matchup
+{
+  int deck;
+  Seat seats[2];
+} Matchup;
+
+typedef struct TournamentJob
+{
+  int matchup;
+  long long first_game;
+  int games;
+} TournamentJob;
+
+typedef struct Tournament
+{
+  DeckTable decks;
+  int max_deck_size;
+  Matchup *matchups;
+  int matchup_count;
+  TournamentJob *jobs;
+  int job_count;
+  MatchStats **worker_stats;
+  GameTally **worker_tallies;
+  uint8_t **worker_decks;
+  const Rules *rules;
+  uint64_t seed;
+} Tournament;
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays the games of one job and adds the outcomes to the statistics of the worker running it.
+/// @param job The index of the job.
+/// @param worker The index of the worker.
+/// @param context A pointer to the tournament.
+static void runTournamentJob(int job, int worker, void *context)
+{
+  Tournament *tournament = context;
+  const TournamentJob *work = &tournament->jobs[job];
+  const Matchup *matchup = &tournament->matchups[work->matchup];
+  Deck deck = tableDeck(&tournament->decks, matchup->deck);
+  uint8_t *game_deck = tournament->worker_decks[worker];
+  MatchStats *stats = &tournament->worker_stats[worker][work->matchup];
+  GameTally *tally = tournament->worker_tallies ? &tournament->worker_tallies[worker][work->matchup] : NULL;
+
+  uint64_t rng = tournament->seed ^ ((uint64_t)work->matchup << 40) ^ (uint64_t)work->first_game;
+  nextRandom(&rng);
+
+  for (int game = 0; game < work->games; game++)
+  {
+    memcpy(game_deck, deck.kinds, deck.size);
+    shuffleDeck(game_deck, deck.size, &rng);
+
+    GameResult outcome;
+    playGame(game_deck, deck.size, matchup->seats, tournament->rules, &rng, &outcome, NULL, tally);
+
+    stats->games++;
+    stats->wins[outcome.winner]++;
+    stats->score[0] += outcome.score[0];
+    stats->score[1] += outcome.score[1];
+    stats->turns += outcome.turns;
+  }
+  statsFlush();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Parses a comma separated list of strategy names.
+/// @param list The list, which is modified while parsing.
+/// @param seats The array receiving the strategies.
+/// @return The number of strategies, or 0 if a name is unknown or the list is too long.
+static int parseStrategies(char *list, Seat *seats)
+{
+  int count = 0;
+  for (char *name = list; name; )
+  {
+    char *comma = strchr(name, ',');
+    if (comma)
+    {
+      *comma = '\0';
+    }
+    if (count == MAX_STRATEGIES || findStrategy(name, &seats[count]) != 0)
+    {
+      return 0;
+    }
+    count++;
+    name = comma ? comma + 1 : NULL;
+  }
+  return count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the usage of the tournament mode.
+/// @return 1, the exit code for invalid arguments.
+static int tournamentUsage(void)
+{
+  printf("Usage: ./a4-csf --tournament <games per matchup> [--threads <count>] [--seed <seed>] "
+         "[--strategies <name,name,...>] [--stats] [--save-scores] [--rules <rule file>] [--csv <file>] "
+         "[--json <file>] [--iterations <count>] [--think <ms>] [--search-threads <count>] "
+         "<config file or directory>...\n");
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Releases everything owned by a tournament.
+/// @param tournament A pointer to the tournament.
+/// @param worker_count The number of workers.
+static void freeTournament(Tournament *tournament, int worker_count)
+{
+  for (int i = 0; i < worker_count; i++)
+  {
+    if (tournament->worker_stats)
+      free(tournament->worker_stats[i]);
+    if (tournament->worker_decks)
+      free(tournament->worker_decks[i]);
+    if (tournament->worker_tallies)
+      free(tournament->worker_tallies[i]);
+  }
+  freeDeckTable(&tournament->decks);
+  free(tournament->matchups);
+  free(tournament->jobs);
+  free(tournament->worker_stats);
+  free(tournament->worker_decks);
+  free(tournament->worker_tallies);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Prints the merged statistics of every matchup.
+/// @param tournament A pointer to the tournament.
+/// @param worker_count The number of workers whose statistics are merged.
+static void printTournament(const Tournament *tournament, int worker_count)
+{
+  for (int m = 0; m < tournament->matchup_count; m++)
+  {
+    MatchStats total = {0, {0, 0, 0}, {0, 0}, 0};
+    for (int w = 0; w < worker_count; w++)
+    {
+      const MatchStats *stats = &tournament->worker_stats[w][m];
+      total.games += stats->games;
+      total.turns += stats->turns;
+      for (int i = 0; i < 3; i++)
+      {
+        total.wins[i] += stats->wins[i];
+      }
+      total.score[0] += stats->score[0];
+      total.score[1] += stats->score[1];
+    }
+
+    const Matchup *matchup = &tournament->matchups[m];
+    double games = total.games > 0 ? (double)total.games : 1.0;
+    printf("%s  %-8s vs %-8s  P1 %6.2f%%  P2 %6.2f%%  ties %6.2f%%  mean score %7.3f : %-7.3f  turns %.2f\n",
+           tournament->decks.entries[matchup->deck].path, matchup->seats[0].name, matchup->seats[1].name,
+           100.0 * total.wins[1] / games, 100.0 * total.wins[2] / games, 100.0 * total.wins[0] / games,
+           total.score[0] / games, total.score[1] / games, total.turns / games);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Merges the tallies of the workers per matchup and exports them.
+/// @param tournament A pointer to the tournament.
+/// @param worker_count The number of workers whose tallies are merged.
+/// @param path The path of the file to write.
+/// @param format The format of the file.
+/// @return 0 if the file was written; 1 if it cannot be written; 4 if there is not enough memory.
+static int exportTournament(const Tournament *tournament, int worker_count, const char *path, TallyFormat format)
+{
+  GameTally *tallies = calloc(tournament->matchup_count, sizeof(GameTally));
+  TallyLabel *labels = malloc(sizeof(TallyLabel) * tournament->matchup_count);
+  if (!tallies || !labels)
+  {
+    free(tallies);
+    free(labels);
+    return 4;
+  }
+
+  for (int m = 0; m < tournament->matchup_count; m++)
+  {
+    const Matchup *matchup = &tournament->matchups[m];
+    labels[m] = (TallyLabel){tournament->decks.entries[matchup->deck].path, matchup->seats[0].name,
+                             matchup->seats[1].name};
+    for (int w = 0; w < worker_count; w++)
+    {
+      mergeTally(&tallies[m], &tournament->worker_tallies[w][m]);
+    }
+  }
+
+  int failed = exportTallies(path, format, labels, tallies, tournament->matchup_count);
+  free(tallies);
+  free(labels);
+  return failed;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Adds the results of all matchups on a deck to the score block of its configuration file, one write per file.
+/// @param tournament A pointer to the tournament.
+/// @param worker_count The number of workers whose statistics are merged.
+/// @return CONFIG_OK if every file was written; otherwise the error of the last file that failed.
+static int saveTournamentScores(const Tournament *tournament, int worker_count)
+{
+  int result = CONFIG_OK;
+  for (int d = 0; d < tournament->decks.count; d++)
+  {
+    ScoreTotals totals = {0, {0, 0}, 0, {0, 0}};
+    for (int m = 0; m < tournament->matchup_count; m++)
+    {
+      if (tournament->matchups[m].deck != d)
+      {
+        continue;
+      }
+      for (int w = 0; w < worker_count; w++)
+      {
+        const MatchStats *stats = &tournament->worker_stats[w][m];
+        totals.games += stats->games;
+        totals.wins[0] += stats->wins[1];
+        totals.wins[1] += stats->wins[2];
+        totals.ties += stats->wins[0];
+        totals.points[0] += stats->score[0];
+        totals.points[1] += stats->score[1];
+      }
+    }
+
+    const char *path = tournament->decks.entries[d].path;
+    int status = saveScores(path, &totals);
+    if (status != CONFIG_OK)
+    {
+      printConfigError(status, path, NULL);
+      result = status;
+    }
+  }
+  return result;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Entry point of the tournament mode started with "--tournament".
+/// Plays the given number of games for every ordered pair of strategies (including self-play) on every deck,
+/// shuffling the deck before every game, and prints the results of every matchup. A directory argument adds every
+/// valid configuration file in it. "--save-scores" adds the results on every deck to its configuration file once
+/// all games have been played. "--rules <rule file>" plays every game with a variant of the rules, which neither
+/// the search strategies nor "--save-scores" support. "--csv <file>" or "--json <file>" exports the aggregated
+/// results, challenges and score margins of every matchup; every worker counts into its own tallies.
+/// @param argc The number of arguments passed to the program from the command line.
+/// @param argv An array of strings representing the command-line arguments.
+/// @return 0 if the tournament finished; 1 for invalid arguments; 2 or 3 for configuration file errors or if the
+/// export cannot be written; 4 if there is not enough memory.
+int runTournament(int argc, char *argv[])
+{
+  if (argc < 4)
+  {
+    return tournamentUsage();
+  }
+
+  char *end = NULL;
+  long long games = strtoll(argv[2], &end, 10);
+  if (*end != '\0' || games < 1)
+  {
+    return tournamentUsage();
+  }
+
+  int worker_count = availableCores();
+  uint64_t seed = 1;
+  Seat strategies[MAX_STRATEGIES];
+  const Seat *builtin = NULL;
+  int builtin_count = listStrategies(&builtin);
+  int strategy_count = 0;
+  IsmctsConfig search = ISMCTS_DEFAULTS;
+  int save_scores = 0;
+  const char *rules_path = NULL;
+  const char *export_path = NULL;
+  TallyFormat export_format = TALLY_CSV;
+
+  // The search players are a hundred to a thousand times slower than the others and have to be asked for
+  // explicitly, and so does the card counter, so that the default field stays the four baseline strategies.
+  for (int j = 0; j < builtin_count; j++)
+  {
+    if (builtin[j].decide != strategyIsmcts && builtin[j].decide != strategyEndgame &&
+        strcmp(builtin[j].name, "counter") != 0)
+    {
+      strategies[strategy_count++] = builtin[j];
+    }
+  }
+
+  int i = 3;
+  for (; i < argc && strncmp(argv[i], "--", 2) == 0; i++)
+  {
+    if (strcmp(argv[i], "--stats") == 0)
+    {
+      enableStats();
+      continue;
+    }
+    if (strcmp(argv[i], "--save-scores") == 0)
+    {
+      save_scores = 1;
+      continue;
+    }
+    if (i + 1 >= argc)
+    {
+      return tournamentUsage();
+    }
+    if (strcmp(argv[i], "--threads") == 0)
+    {
+      worker_count = atoi(argv[++i]);
+      if (worker_count < 1)
+      {
+        return tournamentUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--seed") == 0)
+    {
+      seed = strtoull(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "--strategies") == 0)
+    {
+      strategy_count = parseStrategies(argv[++i], strategies);
+      if (strategy_count == 0)
+      {
+        return tournamentUsage();
+      }
+    }
+    else if (strcmp(argv[i], "--rules") == 0)
+    {
+      rules_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--csv") == 0 || strcmp(argv[i], "--json") == 0)
+    {
+      export_format = argv[i][2] == 'c' ? TALLY_CSV : TALLY_JSON;
+      export_path = argv[++i];
+    }
+    else if (parseSearchOption(argv, &i, argc, &search) != 0)
+    {
+      return tournamentUsage();
+    }
+  }
+
+  for (int j = 0; j < strategy_count; j++)
+  {
+    useSearchConfig(&strategies[j], &search);
+    if (rules_path && !playsVariantRules(&strategies[j]))
+    {
+      return tournamentUsage();
+    }
+  }
+
+  if (i == argc || (rules_path && save_scores))
+  {
+    return tournamentUsage();
+  }
+
+  Rules variant;
+  if (rules_path)
+  {
+    int status = loadRules(rules_path, &variant);
+    if (status != CONFIG_OK)
+    {
+      printConfigError(status, rules_path, NULL);
+      return configExitCode(status);
+    }
+  }
+
+  Tournament tournament;
+  memset(&tournament, 0, sizeof(tournament));
+  tournament.seed = seed;
+  tournament.rules = rules_path && !isStandardRules(&variant) ? &variant : NULL;
+
+  for (; i < argc; i++)
+  {
+    char invalid_line[CONFIG_LINE_SIZE];
+    int status = isDirectory(argv[i]) ? loadConfigDirectory(argv[i], &tournament.decks)
+                                      : appendConfig(&tournament.decks, argv[i], invalid_line);
+    if (status != CONFIG_OK)
+    {
+      printConfigError(status, argv[i], invalid_line);
+      freeTournament(&tournament, 0);
+      return configExitCode(status);
+    }
+  }
+
+  int deck_count = tournament.decks.count;
+  if (deck_count == 0)
+  {
+    printf("Error: No valid configuration files\n");
+    freeTournament(&tournament, 0);
+    return 3;
+  }
+  for (int d = 0; d < deck_count; d++)
+  {
+    if (tournament.decks.entries[d].size > tournament.max_deck_size)
+    {
+      tournament.max_deck_size = tournament.decks.entries[d].size;
+    }
+  }
+
+  tournament.matchup_count = deck_count * strategy_count * strategy_count;
+  tournament.matchups = malloc(sizeof(Matchup) * tournament.matchup_count);
+  long long jobs_per_matchup = (games + GAMES_PER_JOB - 1) / GAMES_PER_JOB;
+  tournament.job_count = (int)(jobs_per_matchup * tournament.matchup_count);
+  tournament.jobs = malloc(sizeof(TournamentJob) * tournament.job_count);
+  if (!tournament.matchups || !tournament.jobs)
+  {
+    printf("Error: Out of memory\n");
+    freeTournament(&tournament, 0);
+    return 4;
+  }
+
+  int job = 0;
+  for (int m = 0; m < tournament.matchup_count; m++)
+  {
+    Matchup *matchup = &tournament.matchups[m];
+    matchup->deck = m / (strategy_count * strategy_count);
+    matchup->seats[0] = strategies[m / strategy_count % strategy_count];
+    matchup->seats[1] = strategies[m % strategy_count];
+
+    for (long long first = 0; first < games; first += GAMES_PER_JOB)
+    {
+      tournament.jobs[job].matchup = m;
+      tournament.jobs[job].first_game = first;
+      tournament.jobs[job].games = (int)(games - first < GAMES_PER_JOB ? games - first : GAMES_PER_JOB);
+      job++;
+    }
+  }
+
+  tournament.worker_stats = calloc(worker_count, sizeof(MatchStats *));
+  tournament.worker_decks = calloc(worker_count, sizeof(uint8_t *));
+  int ready = tournament.worker_stats && tournament.worker_decks;
+  for (int w = 0; ready && w < worker_count; w++)
+  {
+    tournament.worker_stats[w] = calloc(tournament.matchup_count, sizeof(MatchStats));
+    tournament.worker_decks[w] = malloc(tournament.max_deck_size);
+    ready = tournament.worker_stats[w] && tournament.worker_decks[w];
+  }
+  if (ready && export_path)
+  {
+    tournament.worker_tallies = calloc(worker_count, sizeof(GameTally *));
+    ready = tournament.worker_tallies != NULL;
+    for (int w = 0; ready && w < worker_count; w++)
+    {
+      tournament.worker_tallies[w] = calloc(tournament.matchup_count, sizeof(GameTally));
+      ready = tournament.worker_tallies[w] != NULL;
+    }
+  }
+
+  double start = currentSeconds();
+  if (!ready || runJobs(tournament.job_count, worker_count, runTournamentJob, &tournament) != 0)
+  {
+    printf("Error: Out of memory\n");
+    freeTournament(&tournament, worker_count);
+    return 4;
+  }
+  double elapsed = currentSeconds() - start;
+
+  long long total_games = games * tournament.matchup_count;
+  printf("Tournament: %d decks x %d matchups x %lld games on %d threads in %.3f s (%.0f games/s)\n", deck_count,
+         strategy_count * strategy_count, games, worker_count, elapsed, elapsed > 0 ? total_games / elapsed : 0.0);
+  if (tournament.decks.skipped > 0)
+  {
+    printf("Skipped %d invalid configuration files\n", tournament.decks.skipped);
+  }
+  if (rules_path)
+  {
+    printf("Rules: hand %d, penalty %d, bonus %d\n", variant.hand_size, variant.penalty_cards,
+           variant.empty_hand_bonus);
+  }
+  printTournament(&tournament, worker_count);
+  printStats();
+  int status = save_scores ? saveTournamentScores(&tournament, worker_count) : CONFIG_OK;
+  int exported = export_path ? exportTournament(&tournament, worker_count, export_path, export_format) : 0;
+  freeTournament(&tournament, worker_count);
+  if (exported == 4)
+  {
+    printf("Error: Out of memory\n");
+    return 4;
+  }
+  if (exported)
+  {
+    printf("Error: Cannot write file: %s\n", export_path);
+    return 2;
+  }
+  return configExitCode(status);
+}
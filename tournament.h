@@ -0,0 +1,18 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Multi-core self-play tournament of "Entertaining Spice Pretending".
+//
+// Plays every pairing of the selected strategies on every given deck and spreads the games over all cores with the
+// work-stealing pool from pool.c.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+int runTournament(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,112 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Card counting of "Entertaining Spice Pretending".
+//
+// The counts start from the deck without the dealt hand and only ever shrink by one card at a time: when the player
+// draws or has to take a card, and when a challenge of the player reveals the opponent's card. Cards the player
+// plays were already seen in the hand, and cards the opponent plays or takes stay unseen.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <string.h>
+
+#include "tracker.h"
+
+// The value minus 1 and the spice index of every card kind, so that counting a card needs no division.
+static const uint8_t KIND_VALUES[CARD_KINDS] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4,
+                                                5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+static const uint8_t KIND_SPICES[CARD_KINDS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1,
+                                                1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2};
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Starts counting at the deal: every card of the deck is unseen except for the player's hand.
+/// @param tracker A pointer to the tracker to set up.
+/// @param deck_counts The number of cards of each kind in the deck of the game.
+/// @param hand A pointer to the dealt hand of the player.
+void startTracker(CardTracker *tracker, const uint16_t *deck_counts, const Hand *hand)
+{
+  memset(tracker, 0, sizeof(*tracker));
+  for (int index = 0; index < CARD_KINDS; index++)
+  {
+    uint32_t count = deck_counts[index] > hand->counts[index] ? deck_counts[index] - hand->counts[index] : 0;
+    tracker->unseen[index] = count;
+    tracker->value_unseen[KIND_VALUES[index]] += count;
+    tracker->spice_unseen[KIND_SPICES[index]] += count;
+    tracker->total += count;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Counts a card the player has just seen.
+/// @param tracker A pointer to the tracker of the player.
+/// @param index The kind index of the card. A kind without unseen cards is ignored, which only happens if the deck
+/// counts the tracker was started with do not belong to the game.
+void seeCard(CardTracker *tracker, int index)
+{
+  if (index < 0 || !tracker->unseen[index])
+  {
+    return;
+  }
+  tracker->unseen[index]--;
+  tracker->value_unseen[KIND_VALUES[index]]--;
+  tracker->spice_unseen[KIND_SPICES[index]]--;
+  tracker->total--;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Counts the cards the player has taken from the draw pile.
+/// @param tracker A pointer to the tracker of the player.
+/// @param draw_pile A pointer to the draw pile after the cards were taken.
+/// @param first The top of the draw pile before the cards were taken.
+void seeTakenCards(CardTracker *tracker, const DrawPile *draw_pile, int first)
+{
+  for (int i = first; i < draw_pile->top; i++)
+  {
+    seeCard(tracker, draw_pile->kinds[i]);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Counts the cards both players have seen in a move made with applyMove.
+/// @param trackers The trackers of player 1 and player 2.
+/// @param state A pointer to the state after the move.
+/// @param undo A pointer to the record of the move.
+void trackMove(CardTracker trackers[2], const GameState *state, const MoveUndo *undo)
+{
+  if (undo->receiver >= 0)
+  {
+    seeTakenCards(&trackers[undo->receiver], &state->draw_pile, undo->draw_top);
+  }
+  if (undo->type == ACTION_CHALLENGE)
+  {
+    seeCard(&trackers[undo->seat], cardIndex(undo->result.real_value, undo->result.real_spice));
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Looks up the chance that a claim of the opponent is false.
+/// @param tracker A pointer to the tracker of the player.
+/// @param claimed_value The claimed value.
+/// @param claimed_spice The claimed spice.
+/// @param odds A pointer to the structure receiving the chances. Without unseen cards both chances are 0.
+void claimOdds(const CardTracker *tracker, int claimed_value, char claimed_spice, ClaimOdds *odds)
+{
+  int claimed = cardIndex(claimed_value, claimed_spice);
+  odds->claim_unseen = claimed >= 0 && tracker->unseen[claimed] > 0;
+  if (!tracker->total)
+  {
+    odds->value_lie = 0.0;
+    odds->spice_lie = 0.0;
+    return;
+  }
+
+  int spice = cardIndex(1, claimed_spice);
+  uint32_t value_matches = claimed_value >= 1 && claimed_value <= CARD_VALUES ? tracker->value_unseen[claimed_value - 1]
+                                                                              : 0;
+  uint32_t spice_matches = spice >= 0 ? tracker->spice_unseen[KIND_SPICES[spice]] : 0;
+  odds->value_lie = 1.0 - (double)value_matches / tracker->total;
+  odds->spice_lie = 1.0 - (double)spice_matches / tracker->total;
+}
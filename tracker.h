@@ -0,0 +1,48 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Card counting of "Entertaining Spice Pretending".
+//
+// A tracker follows a game from the point of view of one player and counts the cards of the deck that the player
+// has not seen: neither held, nor drawn, nor revealed by a challenge. The opponent's face-down card is one of them,
+// so the counts give the chance that the opponent's claim is false, which a bot or a human player can weigh before
+// challenging. Every event of the game changes the counts in constant time.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <stdint.h>
+
+#include "state.h"
+
+// The unseen cards of each kind, and the same cards counted by value and by spice, so that the chance of a claim
+// being false is a lookup and not a sum over the kinds.
+typedef struct CardTracker
+{
+  uint32_t unseen[CARD_KINDS];
+  uint32_t value_unseen[CARD_VALUES];
+  uint32_t spice_unseen[CARD_KINDS / CARD_VALUES];
+  uint32_t total;
+} CardTracker;
+
+// The chance that the real card of a claim differs from it in value and in spice, if the card is any of the unseen
+// cards with equal probability. claim_unseen is 0 if no card of the claimed kind is unseen, so the claim has to be
+// false in one of the properties.
+typedef struct ClaimOdds
+{
+  double value_lie;
+  double spice_lie;
+  int claim_unseen;
+} ClaimOdds;
+
+void startTracker(CardTracker *tracker, const uint16_t *deck_counts, const Hand *hand);
+void seeCard(CardTracker *tracker, int index);
+void seeTakenCards(CardTracker *tracker, const DrawPile *draw_pile, int first);
+void trackMove(CardTracker trackers[2], const GameState *state, const MoveUndo *undo);
+void claimOdds(const CardTracker *tracker, int claimed_value, char claimed_spice, ClaimOdds *odds);
+
+#endif
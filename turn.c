@@ -0,0 +1,261 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Resumable turn logic of "Entertaining Spice Pretending".
+//
+// The steps follow playerTurn and roundWithChallenges of the interactive game exactly, including how invalid input
+// is treated: a failed play has to be retried with other cards, an unknown command or an invalid challenge type
+// ends the turn, and "quit" with parameters asks for another command. Player 2 always gets its turn after
+// player 1, and only then is the game checked for having run out of cards.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#include <string.h>
+
+#include "stats.h"
+#include "turn.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Appends an event to the events of a step.
+/// @param events A pointer to the events of the step.
+/// @param type The type of the event.
+/// @param seat The player the event concerns.
+/// @return A pointer to the event, with all other fields cleared.
+static TurnEvent *addEvent(TurnEvents *events, TurnEventType type, int seat)
+{
+  TurnEvent *event = &events->events[events->count++];
+  memset(event, 0, sizeof(*event));
+  event->type = type;
+  event->seat = seat;
+  return event;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Ends the game.
+/// @param machine A pointer to the turn machine.
+/// @param events A pointer to the events of the step.
+/// @param scored 1 if the game ended by the rules; 0 if it was quit.
+/// @return EXPECT_NOTHING.
+static TurnExpect endGame(TurnMachine *machine, TurnEvents *events, int scored)
+{
+  machine->state.game_over = 1;
+  addEvent(events, TURN_GAME_OVER, machine->state.seat)->scored = scored;
+  return machine->expect = EXPECT_NOTHING;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Passes the turn to the other player. Once both players have had their turn, the game ends if the draw pile
+/// and both hands are empty.
+/// @param machine A pointer to the turn machine.
+/// @param events A pointer to the events of the step.
+/// @return EXPECT_COMMAND, or EXPECT_NOTHING if the game is over.
+static TurnExpect passTurn(TurnMachine *machine, TurnEvents *events)
+{
+  GameState *state = &machine->state;
+  state->seat = 1 - state->seat;
+  if (state->seat == 0 && pileIsEmpty(&state->draw_pile) && handIsEmpty(&state->players[0].hand) &&
+      handIsEmpty(&state->players[1].hand))
+  {
+    return endGame(machine, events, 1);
+  }
+
+  addEvent(events, TURN_TO_MOVE, state->seat);
+  return machine->expect = EXPECT_COMMAND;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Deals a deck and starts the first round with player 1 to move.
+/// @param machine A pointer to the turn machine to set up.
+/// @param deck The kind indices of the cards in dealing order. It must stay valid while the game is played.
+/// @param deck_size The number of cards in the deck.
+/// @param events A pointer to the events receiving the start of the round and the first turn.
+/// @return EXPECT_COMMAND, or EXPECT_NOTHING if the deck has no cards.
+TurnExpect startTurns(TurnMachine *machine, const uint8_t *deck, int deck_size, TurnEvents *events)
+{
+  uint16_t deck_counts[CARD_KINDS] = {0};
+  for (int i = 0; i < deck_size; i++)
+  {
+    deck_counts[deck[i]]++;
+  }
+
+  events->count = 0;
+  initGameState(&machine->state, deck, deck_size, NULL);
+  startTracker(&machine->trackers[0], deck_counts, &machine->state.players[0].hand);
+  startTracker(&machine->trackers[1], deck_counts, &machine->state.players[1].hand);
+  if (gameStateOver(&machine->state))
+  {
+    return endGame(machine, events, 0);
+  }
+
+  addEvent(events, TURN_ROUND_START, 0);
+  addEvent(events, TURN_TO_MOVE, 0);
+  return machine->expect = EXPECT_COMMAND;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Continues a game whose state and trackers were restored, for example from a checkpoint, with the player to move.
+/// @param machine A pointer to the turn machine holding the game.
+/// @param events A pointer to the events receiving the turn of the player to move.
+/// @return EXPECT_COMMAND, or EXPECT_NOTHING if the game has no cards left.
+TurnExpect resumeTurns(TurnMachine *machine, TurnEvents *events)
+{
+  events->count = 0;
+  if (gameStateOver(&machine->state))
+  {
+    return endGame(machine, events, 1);
+  }
+
+  addEvent(events, TURN_TO_MOVE, machine->state.seat);
+  return machine->expect = EXPECT_COMMAND;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Plays the cards of a play command.
+/// @param machine A pointer to the turn machine.
+/// @param command A pointer to the command.
+/// @param events A pointer to the events of the step.
+/// @return The input expected next.
+static TurnExpect stepPlay(TurnMachine *machine, const TurnCommand *command, TurnEvents *events)
+{
+  GameState *state = &machine->state;
+  const Action *action = &command->action;
+  if (command->error != TURN_OK)
+  {
+    addEvent(events, TURN_REJECTED, state->seat)->error = command->error;
+    return machine->expect = EXPECT_CARDS;
+  }
+
+  STATS_START(lookup_started);
+  int played = playCard(&state->players[state->seat], action->hand_value, action->hand_spice, action->claimed_value,
+                        action->claimed_spice, &state->cards_played_this_round, &state->latest_card_number,
+                        &state->latest_card_spice);
+  STATS_STOP(PHASE_LOOKUP, lookup_started);
+  if (played != 0)
+  {
+    addEvent(events, TURN_REJECTED, state->seat)->error = TURN_NOT_IN_HAND;
+    return machine->expect = EXPECT_CARDS;
+  }
+
+  TurnEvent *event = addEvent(events, TURN_PLAYED, state->seat);
+  event->card = cardIndex(action->hand_value, action->hand_spice);
+  event->claimed_value = action->claimed_value;
+  event->claimed_spice = action->claimed_spice;
+  return passTurn(machine, events);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Resolves a challenge command. A challenge of a player who has not played ends the turn without a challenge, and
+/// either way a new round starts unless the draw pile is empty, which ends the game.
+/// @param machine A pointer to the turn machine.
+/// @param command A pointer to the command.
+/// @param events A pointer to the events of the step.
+/// @return The input expected next.
+static TurnExpect stepChallenge(TurnMachine *machine, const TurnCommand *command, TurnEvents *events)
+{
+  GameState *state = &machine->state;
+  Player *challenger = &state->players[state->seat];
+  Player *opponent = &state->players[1 - state->seat];
+
+  if (!opponent->has_played)
+  {
+    addEvent(events, TURN_CHALLENGE_REFUSED, state->seat);
+  }
+  else
+  {
+    TurnEvent *event = addEvent(events, TURN_CHALLENGED, state->seat);
+    event->claimed_value = state->latest_card_number;
+    event->claimed_spice = (char)state->latest_card_spice;
+    event->challenge_value = command->action.challenge_value;
+    int draw_top = state->draw_pile.top;
+    STATS_START(challenge_started);
+    resolveChallenge(challenger, opponent, event->challenge_value, &state->cards_played_this_round,
+                     &state->draw_pile, &event->result);
+    STATS_STOP(PHASE_CHALLENGE, challenge_started);
+
+    CardTracker *trackers = machine->trackers;
+    seeTakenCards(&trackers[event->result.successful ? 1 - state->seat : state->seat], &state->draw_pile, draw_top);
+    seeCard(&trackers[state->seat], cardIndex(event->result.real_value, event->result.real_spice));
+  }
+
+  if (pileIsEmpty(&state->draw_pile))
+  {
+    return endGame(machine, events, 1);
+  }
+  addEvent(events, TURN_ROUND_START, state->seat);
+  return passTurn(machine, events);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Draws a card, or ends the game if the draw pile is empty before or after drawing.
+/// @param machine A pointer to the turn machine.
+/// @param events A pointer to the events of the step.
+/// @return The input expected next.
+static TurnExpect stepDraw(TurnMachine *machine, TurnEvents *events)
+{
+  GameState *state = &machine->state;
+  if (pileIsEmpty(&state->draw_pile))
+  {
+    return endGame(machine, events, 1);
+  }
+
+  int card = pilePeek(&state->draw_pile, 0);
+  addEvent(events, TURN_DREW, state->seat)->card = card;
+  STATS_START(draw_started);
+  drawCard(&state->players[state->seat], &state->draw_pile);
+  STATS_STOP(PHASE_DRAW, draw_started);
+  seeCard(&machine->trackers[state->seat], card);
+
+  if (pileIsEmpty(&state->draw_pile))
+  {
+    return endGame(machine, events, 1);
+  }
+  return passTurn(machine, events);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/// Executes one command of the player to move.
+/// @param machine A pointer to the turn machine, which must not expect EXPECT_NOTHING.
+/// @param command A pointer to the command. If cards are expected, it has to be a play command with has_cards set
+/// or with the error that prevented parsing the cards, or a quit command if the input ended.
+/// @param events A pointer to the events receiving what happened, ending with the next turn or the end of the game.
+/// @return The input expected next: EXPECT_CARDS if the player has to name the cards of a play, EXPECT_COMMAND if
+/// a player has to enter a command, or EXPECT_NOTHING if the game is over.
+TurnExpect stepTurn(TurnMachine *machine, const TurnCommand *command, TurnEvents *events)
+{
+  events->count = 0;
+  if (machine->expect == EXPECT_CARDS && command->command != COMMAND_QUIT)
+  {
+    return stepPlay(machine, command, events);
+  }
+
+  switch (command->command)
+  {
+    case COMMAND_PLAY:
+      if (!command->has_cards)
+      {
+        return machine->expect = EXPECT_CARDS;
+      }
+      return stepPlay(machine, command, events);
+    case COMMAND_CHALLENGE:
+      if (command->error != TURN_OK)
+      {
+        addEvent(events, TURN_REJECTED, machine->state.seat)->error = command->error;
+        return passTurn(machine, events);
+      }
+      return stepChallenge(machine, command, events);
+    case COMMAND_QUIT:
+      if (command->error != TURN_OK)
+      {
+        addEvent(events, TURN_REJECTED, machine->state.seat)->error = command->error;
+        return machine->expect = EXPECT_COMMAND;
+      }
+      return endGame(machine, events, 0);
+    case COMMAND_DRAW:
+      return stepDraw(machine, events);
+    default:
+      addEvent(events, TURN_REJECTED, machine->state.seat)->error = TURN_UNKNOWN_COMMAND;
+      return passTurn(machine, events);
+  }
+}
@@ -0,0 +1,100 @@
+//---------------------------------------------------------------------------------------------------------------------
+// Resumable turn logic of "Entertaining Spice Pretending".
+//
+// The rules of a game played command by command, as the interactive game plays it, without any input or output.
+// The caller feeds one parsed command at a time to stepTurn and gets back what happened as events and what kind of
+// input the game waits for next, so the same game can be driven by stdin, a socket, a strategy or a log, and can
+// be paused between any two commands.
+//
+// Tutor: Hannah Weberbauer>
+//
+// Milos Dukaric: <12225387>
+//---------------------------------------------------------------------------------------------------------------------
+//
+
+#ifndef TURN_H
+#define TURN_H
+
+#include "input.h"
+#include "state.h"
+#include "tracker.h"
+
+// Largest number of events a single step produces.
+#define TURN_MAX_EVENTS 4
+
+typedef enum TurnExpect
+{
+  EXPECT_COMMAND,
+  EXPECT_CARDS,
+  EXPECT_NOTHING
+} TurnExpect;
+
+typedef enum TurnError
+{
+  TURN_OK,
+  TURN_WRONG_PARAMETERS,
+  TURN_CARD_FORMAT,
+  TURN_NOT_IN_HAND,
+  TURN_CHALLENGE_TYPE,
+  TURN_UNKNOWN_COMMAND
+} TurnError;
+
+// A command as parsed by the caller. A play without has_cards only announces the cards, which are then expected
+// as a separate play command with has_cards set. Syntax errors found while parsing are passed on in error, since
+// they decide how the turn goes on as well.
+typedef struct TurnCommand
+{
+  Command command;
+  TurnError error;
+  int has_cards;
+  Action action;
+} TurnCommand;
+
+typedef enum TurnEventType
+{
+  TURN_ROUND_START,
+  TURN_TO_MOVE,
+  TURN_PLAYED,
+  TURN_DREW,
+  TURN_CHALLENGED,
+  TURN_CHALLENGE_REFUSED,
+  TURN_REJECTED,
+  TURN_GAME_OVER
+} TurnEventType;
+
+// Something that happened in a step. seat is the player it concerns: the player to move for TURN_TO_MOVE, the
+// player who moved for the moves, and for TURN_GAME_OVER the player whose move ended the game. card is the kind
+// index of a played or drawn card. claimed_value and claimed_spice are the claim of a play, or the claim that was
+// challenged. scored is set for TURN_GAME_OVER if the game ended by the rules and not by "quit".
+typedef struct TurnEvent
+{
+  TurnEventType type;
+  int seat;
+  int card;
+  int claimed_value;
+  char claimed_spice;
+  int challenge_value;
+  int scored;
+  TurnError error;
+  ChallengeResult result;
+} TurnEvent;
+
+typedef struct TurnEvents
+{
+  int count;
+  TurnEvent events[TURN_MAX_EVENTS];
+} TurnEvents;
+
+// The state of a game and what each player has seen of it.
+typedef struct TurnMachine
+{
+  GameState state;
+  TurnExpect expect;
+  CardTracker trackers[2];
+} TurnMachine;
+
+TurnExpect startTurns(TurnMachine *machine, const uint8_t *deck, int deck_size, TurnEvents *events);
+TurnExpect resumeTurns(TurnMachine *machine, TurnEvents *events);
+TurnExpect stepTurn(TurnMachine *machine, const TurnCommand *command, TurnEvents *events);
+
+#endif